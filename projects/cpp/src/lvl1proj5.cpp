@@ -3,6 +3,27 @@
 #include <cmath>
 #include <iomanip>
 #include <algorithm>
+#include <array>
+#include <complex>
+#include <stdexcept>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <random>
+#include <limits>
+#include <fstream>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <cstdlib>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 using namespace std;
 
@@ -106,6 +127,8 @@ Polynomial multiply(const Polynomial& p1, const Polynomial& p2) {
     Polynomial result(resultDegree);
     
     for (int i = 0; i <= p1.degree(); i++) {
+        if (p1.coefficients[i] == 0) continue;
+        
         for (int j = 0; j <= p2.degree(); j++) {
             result.coefficients[i + j] += p1.coefficients[i] * p2.coefficients[j];
         }
@@ -115,32 +138,1074 @@ Polynomial multiply(const Polynomial& p1, const Polynomial& p2) {
     return result;
 }
 
-double hornerRecursive(const vector<double>& coefs, int index, double x) {
+const double PI = acos(-1.0);
+
+bool isZero(const Polynomial& p) {
+    return p.degree() == 0 && abs(p.coefficients[0]) < 1e-10;
+}
+
+int workerCount() {
+    return max(1u, thread::hardware_concurrency());
+}
+
+// Параллельный цикл по диапазону [0, count): каждый поток получает свой отрезок
+template <typename Func>
+void parallelFor(int count, Func body, int grain = 256) {
+    int threads = workerCount();
+    if (threads == 1 || count < grain) {
+        body(0, count);
+        return;
+    }
+    
+    threads = min(threads, count);
+    vector<thread> workers;
+    int chunk = (count + threads - 1) / threads;
+    
+    for (int t = 0; t < threads; t++) {
+        int begin = t * chunk;
+        int end = min(count, begin + chunk);
+        if (begin >= end) break;
+        workers.emplace_back(body, begin, end);
+    }
+    
+    for (thread& worker : workers) {
+        worker.join();
+    }
+}
+
+void fft(vector<complex<double>>& a, bool invert) {
+    int n = a.size();
+    
+    for (int i = 1, j = 0; i < n; i++) {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) swap(a[i], a[j]);
+    }
+    
+    // Таблица корней из единицы считается один раз, чтобы не копить ошибку округления
+    vector<complex<double>> roots(n / 2);
+    for (int i = 0; i < n / 2; i++) {
+        roots[i] = polar(1.0, (invert ? -2 : 2) * PI * i / n);
+    }
+    
+    for (int len = 2; len <= n; len <<= 1) {
+        int step = n / len;
+        for (int i = 0; i < n; i += len) {
+            for (int j = 0; j < len / 2; j++) {
+                complex<double> u = a[i + j];
+                complex<double> v = a[i + j + len / 2] * roots[j * step];
+                a[i + j] = u + v;
+                a[i + j + len / 2] = u - v;
+            }
+        }
+    }
+    
+    if (invert) {
+        for (complex<double>& x : a) {
+            x /= n;
+        }
+    }
+}
+
+vector<double> multiplyCoefficients(const vector<double>& a, const vector<double>& b) {
+    if (a.empty() || b.empty()) {
+        return {};
+    }
+    
+    size_t resultSize = a.size() + b.size() - 1;
+    
+    // Для небольших множителей схема "в столбик" быстрее БПФ
+    if (min(a.size(), b.size()) < 32 || (double)a.size() * b.size() < 262144) {
+        vector<double> result(resultSize, 0.0);
+        for (size_t i = 0; i < a.size(); i++) {
+            for (size_t j = 0; j < b.size(); j++) {
+                result[i + j] += a[i] * b[j];
+            }
+        }
+        return result;
+    }
+    
+    size_t n = 1;
+    while (n < resultSize) n <<= 1;
+    
+    vector<complex<double>> fa(a.begin(), a.end());
+    vector<complex<double>> fb(b.begin(), b.end());
+    fa.resize(n);
+    fb.resize(n);
+    
+    fft(fa, false);
+    fft(fb, false);
+    for (size_t i = 0; i < n; i++) {
+        fa[i] *= fb[i];
+    }
+    fft(fa, true);
+    
+    vector<double> result(resultSize);
+    for (size_t i = 0; i < resultSize; i++) {
+        result[i] = fa[i].real();
+    }
+    return result;
+}
+
+// Быстрое умножение через БПФ, O(n log n)
+Polynomial multiplyFast(const Polynomial& p1, const Polynomial& p2) {
+    return Polynomial(multiplyCoefficients(p1.coefficients, p2.coefficients));
+}
+
+// Деление столбиком: возвращает частное, остаток записывается в remainder
+Polynomial divide(const Polynomial& dividend, const Polynomial& divisor, Polynomial& remainder) {
+    if (isZero(divisor)) {
+        throw runtime_error("Division by zero polynomial");
+    }
+    
+    int n = dividend.degree();
+    int m = divisor.degree();
+    
+    if (n < m) {
+        remainder = dividend;
+        return Polynomial(0);
+    }
+    
+    vector<double> rest = dividend.coefficients;
+    vector<double> quotient(n - m + 1, 0.0);
+    double lead = divisor.coefficients[m];
+    
+    for (int i = n - m; i >= 0; i--) {
+        double coef = rest[i + m] / lead;
+        quotient[i] = coef;
+        
+        for (int j = 0; j <= m; j++) {
+            rest[i + j] -= coef * divisor.coefficients[j];
+        }
+        rest[i + m] = 0;
+    }
+    
+    rest.resize(max(m, 1));
+    remainder = Polynomial(rest);
+    return Polynomial(quotient);
+}
+
+// Обратный степенной ряд: g такой, что f * g = 1 (mod x^n), итерации Ньютона g = g(2 - fg)
+vector<double> inverseSeries(const vector<double>& f, int n) {
+    vector<double> g = {1.0 / f[0]};
+    int precision = 1;
+    
+    while (precision < n) {
+        precision = min(2 * precision, n);
+        
+        vector<double> head(f.begin(), f.begin() + min<size_t>(precision, f.size()));
+        vector<double> correction = multiplyCoefficients(head, g);
+        correction.resize(precision, 0.0);
+        
+        for (double& c : correction) {
+            c = -c;
+        }
+        correction[0] += 2.0;
+        
+        g = multiplyCoefficients(g, correction);
+        g.resize(precision, 0.0);
+    }
+    
+    return g;
+}
+
+// Быстрое деление через обратный ряд Ньютона, O(n log n)
+Polynomial divideFast(const Polynomial& dividend, const Polynomial& divisor, Polynomial& remainder) {
+    if (isZero(divisor)) {
+        throw runtime_error("Division by zero polynomial");
+    }
+    
+    int n = dividend.degree();
+    int m = divisor.degree();
+    
+    if (n < m) {
+        remainder = dividend;
+        return Polynomial(0);
+    }
+    
+    int quotientSize = n - m + 1;
+    if (m < 32 || quotientSize < 32) {
+        return divide(dividend, divisor, remainder);
+    }
+    
+    vector<double> revDividend(dividend.coefficients.rbegin(), dividend.coefficients.rend());
+    vector<double> revDivisor(divisor.coefficients.rbegin(), divisor.coefficients.rend());
+    revDividend.resize(quotientSize);
+    
+    vector<double> revQuotient = multiplyCoefficients(revDividend, inverseSeries(revDivisor, quotientSize));
+    revQuotient.resize(quotientSize);
+    
+    vector<double> quotient(revQuotient.rbegin(), revQuotient.rend());
+    vector<double> product = multiplyCoefficients(divisor.coefficients, quotient);
+    
+    vector<double> rest(m);
+    for (int i = 0; i < m; i++) {
+        rest[i] = dividend.coefficients[i] - product[i];
+    }
+    
+    remainder = Polynomial(rest);
+    return Polynomial(quotient);
+}
+
+double maxAbsCoefficient(const Polynomial& p) {
+    double result = 0;
+    for (double c : p.coefficients) {
+        result = max(result, abs(c));
+    }
+    return result;
+}
+
+Polynomial makeMonic(Polynomial p) {
+    double lead = p.coefficients.back();
+    for (double& c : p.coefficients) {
+        c /= lead;
+    }
+    return p;
+}
+
+// Делит коэффициенты на наибольший по модулю: норма становится равной 1
+Polynomial scaleToUnitNorm(Polynomial p) {
+    double norm = maxAbsCoefficient(p);
+    for (double& c : p.coefficients) {
+        c /= norm;
+    }
+    return p;
+}
 
-    if (index < 0) {
-        return 0;
+// НОД по алгоритму Евклида. Каждый остаток приводится к единичной норме, чтобы коэффициенты
+// не росли и не вырождались; остаток считается нулевым, когда его норма не больше tolerance
+// от нормы делителя. На случайных многочленах степени до нескольких сотен остаток на шаге НОД
+// обычно меньше 1e-9, а на остальных шагах - больше 1e-6
+Polynomial gcd(const Polynomial& p1, const Polynomial& p2, double tolerance = 1e-7) {
+    if (isZero(p2)) {
+        return isZero(p1) ? p1 : makeMonic(p1);
     }
+    if (isZero(p1)) {
+        return makeMonic(p2);
+    }
+    
+    Polynomial a = scaleToUnitNorm(p1);
+    Polynomial b = scaleToUnitNorm(p2);
     
-    return coefs[index] + x * hornerRecursive(coefs, index - 1, x);
+    while (true) {
+        Polynomial remainder;
+        divideFast(a, b, remainder);
+        
+        if (maxAbsCoefficient(remainder) <= tolerance * maxAbsCoefficient(b)) {
+            return makeMonic(b);
+        }
+        
+        a = b;
+        b = scaleToUnitNorm(remainder);
+    }
 }
 
 double evaluateHorner(const Polynomial& p, double x) {
-    if (p.coefficients.empty()) {
-        return 0;
+    double result = 0;
+    for (int i = p.degree(); i >= 0; i--) {
+        result = result * x + p.coefficients[i];
     }
-    return hornerRecursive(p.coefficients, p.degree(), x);
+    return result;
 }
 
 double evaluateDirect(const Polynomial& p, double x) {
     double result = 0;
     double power = 1;
     
-    for (int i = 0; i <= p.degree(); i++) {
-        result += p.coefficients[i] * power;
-        power *= x;
+    for (int i = 0; i <= p.degree(); i++) {
+        result += p.coefficients[i] * power;
+        power *= x;
+    }
+    
+    return result;
+}
+
+const double UNIT_ROUNDOFF = numeric_limits<double>::epsilon() / 2;
+
+double errorGamma(int k) {
+    return k * UNIT_ROUNDOFF / (1 - k * UNIT_ROUNDOFF);
+}
+
+struct EvaluationResult {
+    double value;
+    double errorBound;
+};
+
+// Безошибочные преобразования: a + b = sum + error, a * b = product + error точно
+void twoSum(double a, double b, double& sum, double& error) {
+    sum = a + b;
+    double virtualB = sum - a;
+    error = (a - (sum - virtualB)) + (b - virtualB);
+}
+
+// Без аппаратного FMA std::fma эмулируется программно, поэтому используется разбиение Деккера
+void split(double a, double& hi, double& lo) {
+    double t = 134217729.0 * a;
+    hi = t - (t - a);
+    lo = a - hi;
+}
+
+void twoProduct(double a, double b, double& product, double& error) {
+    product = a * b;
+#ifdef FP_FAST_FMA
+    error = fma(a, b, -product);
+#else
+    double aHi, aLo, bHi, bLo;
+    split(a, aHi, aLo);
+    split(b, bHi, bLo);
+    error = aLo * bLo - (((product - aHi * bHi) - aLo * bHi) - aHi * bLo);
+#endif
+}
+
+// Горнер с текущей оценкой погрешности (Хайэм, алгоритм 5.1)
+EvaluationResult evaluateHornerWithBound(const Polynomial& p, double x) {
+    const vector<double>& coefs = p.coefficients;
+    double value = coefs.back();
+    double mu = abs(value) / 2;
+    
+    for (int i = p.degree() - 1; i >= 0; i--) {
+        value = value * x + coefs[i];
+        mu = mu * abs(x) + abs(value);
+    }
+    
+    return {value, UNIT_ROUNDOFF * (2 * mu - abs(value))};
+}
+
+// Компенсированный Горнер: ошибки каждого шага накапливаются отдельно и добавляются в конце,
+// результат точен так, как если бы считали с двойной точностью
+EvaluationResult evaluateCompensated(const Polynomial& p, double x) {
+    const vector<double>& coefs = p.coefficients;
+    int n = p.degree();
+    double value = coefs[n];
+    double correction = 0;
+    double absolute = abs(coefs[n]);
+    
+    for (int i = n - 1; i >= 0; i--) {
+        double product, productError, sumError;
+        twoProduct(value, x, product, productError);
+        twoSum(product, coefs[i], value, sumError);
+        correction = correction * x + (productError + sumError);
+        absolute = absolute * abs(x) + abs(coefs[i]);
+    }
+    
+    double result = value + correction;
+    double bound = (UNIT_ROUNDOFF * abs(result) + errorGamma(2 * n) * errorGamma(2 * n) * absolute) / (1 - UNIT_ROUNDOFF);
+    return {result, bound};
+}
+
+struct DoubleDouble {
+    double hi;
+    double lo;
+};
+
+DoubleDouble multiply(DoubleDouble a, double b) {
+    double product, error;
+    twoProduct(a.hi, b, product, error);
+    error += a.lo * b;
+    double hi = product + error;
+    return {hi, error - (hi - product)};
+}
+
+DoubleDouble add(DoubleDouble a, double b) {
+    double sum, error;
+    twoSum(a.hi, b, sum, error);
+    error += a.lo;
+    double hi = sum + error;
+    return {hi, error - (hi - sum)};
+}
+
+// Горнер в арифметике double-double (~106 бит мантиссы)
+EvaluationResult evaluateDoubleDouble(const Polynomial& p, double x) {
+    const vector<double>& coefs = p.coefficients;
+    int n = p.degree();
+    DoubleDouble value = {coefs[n], 0.0};
+    double absolute = abs(coefs[n]);
+    
+    for (int i = n - 1; i >= 0; i--) {
+        value = add(multiply(value, x), coefs[i]);
+        absolute = absolute * abs(x) + abs(coefs[i]);
+    }
+    
+    double result = value.hi + value.lo;
+    double bound = UNIT_ROUNDOFF * abs(result) + (4 * n + 2) * UNIT_ROUNDOFF * UNIT_ROUNDOFF * absolute;
+    return {result, bound};
+}
+
+// Выбор точности по месту вызова: быстрый путь, если его оценки хватает для относительной точности tolerance
+EvaluationResult evaluateAdaptive(const Polynomial& p, double x, double tolerance) {
+    EvaluationResult result = evaluateHornerWithBound(p, x);
+    if (result.errorBound <= tolerance * abs(result.value)) {
+        return result;
+    }
+    
+    result = evaluateCompensated(p, x);
+    if (result.errorBound <= tolerance * abs(result.value)) {
+        return result;
+    }
+    
+    return evaluateDoubleDouble(p, x);
+}
+
+// Многочлен фиксированной степени N без кучи; все вычисления разворачиваются на этапе компиляции
+template <int N>
+struct FixedPolynomial {
+    static_assert(N >= 0, "Degree must be non-negative");
+    
+    array<double, N + 1> coefficients{};
+    
+    constexpr FixedPolynomial() = default;
+    
+    constexpr FixedPolynomial(const array<double, N + 1>& coefs) : coefficients(coefs) {}
+    
+    static constexpr int degree() {
+        return N;
+    }
+    
+    static FixedPolynomial fromPolynomial(const Polynomial& p) {
+        if (p.degree() > N) {
+            throw runtime_error("Polynomial degree exceeds fixed degree");
+        }
+        
+        FixedPolynomial result;
+        for (int i = 0; i <= p.degree(); i++) {
+            result.coefficients[i] = p.coefficients[i];
+        }
+        return result;
+    }
+    
+    Polynomial toPolynomial() const {
+        return Polynomial(vector<double>(coefficients.begin(), coefficients.end()));
+    }
+    
+    constexpr double evaluateHorner(double x) const {
+        return hornerFrom<N - 1>(x, coefficients[N]);
+    }
+    
+    // Схема Эстрина: пары коэффициентов считаются независимо, меньше зависимость по данным
+    constexpr double evaluateEstrin(double x) const {
+        return estrin<0, N + 1>(x);
+    }
+    
+    constexpr FixedPolynomial<(N > 0 ? N - 1 : 0)> derivative() const {
+        FixedPolynomial<(N > 0 ? N - 1 : 0)> result;
+        for (int i = 1; i <= N; i++) {
+            result.coefficients[i - 1] = coefficients[i] * i;
+        }
+        return result;
+    }
+    
+private:
+    template <int I>
+    constexpr double hornerFrom(double x, double acc) const {
+        if constexpr (I < 0) {
+            return acc;
+        } else {
+            return hornerFrom<I - 1>(x, acc * x + coefficients[I]);
+        }
+    }
+    
+    template <int Power>
+    static constexpr double power(double x) {
+        if constexpr (Power == 0) {
+            return 1.0;
+        } else if constexpr (Power % 2 == 0) {
+            return power<Power / 2>(x) * power<Power / 2>(x);
+        } else {
+            return x * power<Power - 1>(x);
+        }
+    }
+    
+    static constexpr int largestPowerOfTwoBelow(int count) {
+        int result = 1;
+        while (result * 2 < count) result *= 2;
+        return result;
+    }
+    
+    template <int Begin, int Count>
+    constexpr double estrin(double x) const {
+        if constexpr (Count == 1) {
+            return coefficients[Begin];
+        } else if constexpr (Count == 2) {
+            return coefficients[Begin] + coefficients[Begin + 1] * x;
+        } else {
+            constexpr int half = largestPowerOfTwoBelow(Count);
+            return estrin<Begin, half>(x) + power<half>(x) * estrin<Begin + half, Count - half>(x);
+        }
+    }
+};
+
+template <int N, int M>
+constexpr FixedPolynomial<(N > M ? N : M)> add(const FixedPolynomial<N>& p1, const FixedPolynomial<M>& p2) {
+    FixedPolynomial<(N > M ? N : M)> result;
+    for (int i = 0; i <= N; i++) result.coefficients[i] += p1.coefficients[i];
+    for (int i = 0; i <= M; i++) result.coefficients[i] += p2.coefficients[i];
+    return result;
+}
+
+template <int N, int M>
+constexpr FixedPolynomial<N + M> multiply(const FixedPolynomial<N>& p1, const FixedPolynomial<M>& p2) {
+    FixedPolynomial<N + M> result;
+    for (int i = 0; i <= N; i++) {
+        for (int j = 0; j <= M; j++) {
+            result.coefficients[i + j] += p1.coefficients[i] * p2.coefficients[j];
+        }
+    }
+    return result;
+}
+
+template <int N>
+constexpr double evaluateHorner(const FixedPolynomial<N>& p, double x) {
+    return p.evaluateHorner(x);
+}
+
+template <int N>
+constexpr double evaluateEstrin(const FixedPolynomial<N>& p, double x) {
+    return p.evaluateEstrin(x);
+}
+
+// Ряд Тейлора для exp(x): коэффициенты 1/k! вычисляются компилятором
+template <int N>
+constexpr FixedPolynomial<N> taylorExp() {
+    FixedPolynomial<N> result;
+    double factorial = 1;
+    for (int k = 0; k <= N; k++) {
+        result.coefficients[k] = 1.0 / factorial;
+        factorial *= k + 1;
+    }
+    return result;
+}
+
+// Проверки на этапе компиляции: (1 + x)(1 - x) = 1 - x^2
+constexpr FixedPolynomial<1> onePlusX({1.0, 1.0});
+constexpr FixedPolynomial<1> oneMinusX({1.0, -1.0});
+constexpr FixedPolynomial<2> squareDifference = multiply(onePlusX, oneMinusX);
+static_assert(squareDifference.evaluateHorner(3.0) == -8.0, "constexpr Horner");
+static_assert(squareDifference.evaluateEstrin(3.0) == -8.0, "constexpr Estrin");
+static_assert(taylorExp<6>().derivative().evaluateHorner(0.0) == 1.0, "constexpr derivative");
+
+// Отношение p(z) / p'(z); при |z| > 1 считается через развернутый многочлен, чтобы не было переполнения
+complex<double> newtonCorrection(const vector<double>& coefs, complex<double> z) {
+    int n = coefs.size() - 1;
+    complex<double> value = 0, derivative = 0;
+    
+    if (abs(z) <= 1) {
+        for (int i = n; i >= 0; i--) {
+            derivative = derivative * z + value;
+            value = value * z + coefs[i];
+        }
+        return derivative == 0.0 ? value : value / derivative;
+    }
+    
+    complex<double> y = 1.0 / z;
+    for (int i = 0; i <= n; i++) {
+        derivative = derivative * y + value;
+        value = value * y + coefs[i];
+    }
+    
+    complex<double> denominator = (double)n * value - y * derivative;
+    return denominator == 0.0 ? value : z * value / denominator;
+}
+
+// Все корни сразу методом Эрлиха-Аберта; итерации распараллелены по корням. Потоки создаются
+// один раз: каждый ведет свой отрезок корней через все итерации, а между итерациями ждет
+// остальных на барьере. Последний пришедший к барьеру меняет приближения и проверяет сходимость
+vector<complex<double>> findRoots(const Polynomial& p, int maxIterations = 500, double tolerance = 1e-12) {
+    int n = p.degree();
+    vector<complex<double>> roots;
+    
+    if (n < 1) {
+        return roots;
+    }
+    
+    const vector<double>& coefs = p.coefficients;
+    double radius = pow(abs(coefs[0]) / abs(coefs[n]), 1.0 / n);
+    if (radius == 0 || !isfinite(radius)) radius = 1;
+    
+    for (int k = 0; k < n; k++) {
+        roots.push_back(polar(radius, 2 * PI * k / n + 0.4));
+    }
+    
+    vector<complex<double>> next(n);
+    vector<char> converged(n, 0);
+    
+    int threads = n < 256 ? 1 : min(workerCount(), n);
+    mutex lock;
+    condition_variable released;
+    int arrived = 0;
+    int generation = 0;
+    bool finished = false;
+    
+    auto barrier = [&] {
+        unique_lock<mutex> guard(lock);
+        int current = generation;
+        if (++arrived == threads) {
+            arrived = 0;
+            roots.swap(next);
+            finished = count(converged.begin(), converged.end(), 1) == n;
+            generation++;
+            released.notify_all();
+        } else {
+            released.wait(guard, [&] { return generation != current; });
+        }
+    };
+    
+    auto worker = [&](int begin, int end) {
+        for (int iteration = 0; iteration < maxIterations && !finished; iteration++) {
+            for (int i = begin; i < end; i++) {
+                next[i] = roots[i];
+                if (converged[i]) continue;
+                
+                complex<double> ratio = newtonCorrection(coefs, roots[i]);
+                complex<double> sum = 0;
+                for (int j = 0; j < n; j++) {
+                    if (j != i) sum += 1.0 / (roots[i] - roots[j]);
+                }
+                
+                complex<double> step = ratio / (1.0 - ratio * sum);
+                next[i] = roots[i] - step;
+                
+                if (abs(step) <= tolerance * max(1.0, abs(next[i]))) {
+                    converged[i] = 1;
+                }
+            }
+            barrier();
+        }
+    };
+    
+    vector<thread> workers;
+    int chunk = (n + threads - 1) / threads;
+    for (int t = 1; t < threads; t++) {
+        workers.emplace_back(worker, min(n, t * chunk), min(n, (t + 1) * chunk));
+    }
+    worker(0, min(n, chunk));
+    
+    for (thread& running : workers) {
+        running.join();
+    }
+    
+    return roots;
+}
+
+// Многочлен от нескольких переменных: показатели одного одночлена упакованы в 64-битное слово,
+// на каждую переменную отводится 64 / variables бит
+struct MultiPolynomial {
+    static const int MAX_VARIABLES = 8;
+    
+    int variables;
+    vector<uint64_t> monomials;
+    vector<double> coefficients;
+    
+    MultiPolynomial(int vars = 1) : variables(vars) {
+        if (vars < 1 || vars > MAX_VARIABLES) {
+            throw runtime_error("Number of variables must be from 1 to 8");
+        }
+    }
+    
+    int bitsPerVariable() const {
+        return 64 / variables;
+    }
+    
+    uint64_t fieldMask() const {
+        return bitsPerVariable() == 64 ? ~0ULL : (1ULL << bitsPerVariable()) - 1;
+    }
+    
+    uint64_t maxExponent() const {
+        return min<uint64_t>(fieldMask(), numeric_limits<int>::max());
+    }
+    
+    int exponent(uint64_t monomial, int variable) const {
+        return (monomial >> (variable * bitsPerVariable())) & fieldMask();
+    }
+    
+    void addTerm(const vector<int>& exponents, double coef) {
+        if ((int)exponents.size() != variables) {
+            throw runtime_error("Wrong number of exponents");
+        }
+        
+        uint64_t monomial = 0;
+        for (int i = 0; i < variables; i++) {
+            if (exponents[i] < 0 || (uint64_t)exponents[i] > maxExponent()) {
+                throw runtime_error("Exponent out of range");
+            }
+            monomial |= (uint64_t)exponents[i] << (i * bitsPerVariable());
+        }
+        
+        monomials.push_back(monomial);
+        coefficients.push_back(coef);
+    }
+    
+    // Сортировка одночленов, сложение подобных и удаление нулевых
+    void normalize() {
+        vector<pair<uint64_t, double>> sorted(monomials.size());
+        for (size_t i = 0; i < sorted.size(); i++) {
+            sorted[i] = {monomials[i], coefficients[i]};
+        }
+        sort(sorted.begin(), sorted.end(),
+             [](const pair<uint64_t, double>& a, const pair<uint64_t, double>& b) { return a.first < b.first; });
+        
+        monomials.clear();
+        coefficients.clear();
+        
+        for (size_t i = 0; i < sorted.size(); ) {
+            uint64_t monomial = sorted[i].first;
+            double coef = 0;
+            for (; i < sorted.size() && sorted[i].first == monomial; i++) {
+                coef += sorted[i].second;
+            }
+            
+            if (abs(coef) >= 1e-10) {
+                monomials.push_back(monomial);
+                coefficients.push_back(coef);
+            }
+        }
+    }
+    
+    int terms() const {
+        return monomials.size();
+    }
+    
+    // Одночлены строго возрастают, как после normalize(); addTerm этого не поддерживает
+    bool isNormalized() const {
+        for (size_t i = 1; i < monomials.size(); i++) {
+            if (monomials[i - 1] >= monomials[i]) return false;
+        }
+        return true;
+    }
+    
+    int degreeIn(int variable) const {
+        int result = 0;
+        for (uint64_t monomial : monomials) {
+            result = max(result, exponent(monomial, variable));
+        }
+        return result;
+    }
+    
+    static MultiPolynomial fromPolynomial(const Polynomial& p) {
+        MultiPolynomial result(1);
+        for (int i = 0; i <= p.degree(); i++) {
+            if (abs(p.coefficients[i]) >= 1e-10) {
+                result.monomials.push_back(i);
+                result.coefficients.push_back(p.coefficients[i]);
+            }
+        }
+        return result;
+    }
+    
+    void display() const {
+        if (monomials.empty()) {
+            cout << "0";
+            return;
+        }
+        
+        for (int t = terms() - 1; t >= 0; t--) {
+            double coef = coefficients[t];
+            bool constant = monomials[t] == 0;
+            
+            if (t != terms() - 1) {
+                cout << (coef > 0 ? " + " : " - ");
+                coef = abs(coef);
+            } else if (coef < 0) {
+                cout << "-";
+                coef = abs(coef);
+            }
+            
+            if (constant || abs(coef - 1.0) > 1e-10) {
+                cout << defaultfloat << coef;
+            }
+            
+            for (int v = 0; v < variables; v++) {
+                int e = exponent(monomials[t], v);
+                if (e == 0) continue;
+                cout << "x" << v + 1;
+                if (e > 1) cout << "^" << e;
+            }
+        }
+    }
+};
+
+MultiPolynomial add(const MultiPolynomial& p1, const MultiPolynomial& p2) {
+    if (p1.variables != p2.variables) {
+        throw runtime_error("Polynomials have different numbers of variables");
+    }
+    
+    MultiPolynomial result(p1.variables);
+    result.monomials = p1.monomials;
+    result.coefficients = p1.coefficients;
+    result.monomials.insert(result.monomials.end(), p2.monomials.begin(), p2.monomials.end());
+    result.coefficients.insert(result.coefficients.end(), p2.coefficients.begin(), p2.coefficients.end());
+    result.normalize();
+    return result;
+}
+
+// Хеш-таблица с открытой адресацией для накопления коэффициентов произведения
+class MonomialTable {
+private:
+    vector<uint64_t> keys;
+    vector<double> values;
+    vector<char> used;
+    size_t mask;
+    size_t count;
+    
+    static size_t hash(uint64_t key) {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        return key;
+    }
+    
+    void grow() {
+        vector<uint64_t> oldKeys;
+        vector<double> oldValues;
+        vector<char> oldUsed;
+        oldKeys.swap(keys);
+        oldValues.swap(values);
+        oldUsed.swap(used);
+        
+        reset(oldKeys.size() * 2);
+        for (size_t i = 0; i < oldKeys.size(); i++) {
+            if (oldUsed[i]) add(oldKeys[i], oldValues[i]);
+        }
+    }
+    
+    void reset(size_t capacity) {
+        keys.assign(capacity, 0);
+        values.assign(capacity, 0.0);
+        used.assign(capacity, 0);
+        mask = capacity - 1;
+        count = 0;
+    }
+    
+public:
+    MonomialTable(size_t expected = 1024) {
+        size_t capacity = 16;
+        while (capacity < expected * 2) capacity <<= 1;
+        reset(capacity);
+    }
+    
+    void add(uint64_t key, double value) {
+        size_t slot = hash(key) & mask;
+        while (used[slot] && keys[slot] != key) {
+            slot = (slot + 1) & mask;
+        }
+        
+        if (!used[slot]) {
+            used[slot] = 1;
+            keys[slot] = key;
+            values[slot] = value;
+            if (++count * 2 > keys.size()) grow();
+            return;
+        }
+        
+        values[slot] += value;
+    }
+    
+    template <typename Func>
+    void forEach(Func visit) const {
+        for (size_t i = 0; i < keys.size(); i++) {
+            if (used[i]) visit(keys[i], values[i]);
+        }
+    }
+};
+
+// Если плотная "коробка" показателей невелика, произведение считается подстановкой Кронекера
+// через одномерное быстрое умножение; иначе - хеш-умножение, параллельное по одночленам p1
+MultiPolynomial multiply(const MultiPolynomial& p1, const MultiPolynomial& p2) {
+    if (p1.variables != p2.variables) {
+        throw runtime_error("Polynomials have different numbers of variables");
+    }
+    
+    if (!p1.isNormalized() || !p2.isNormalized()) {
+        MultiPolynomial sorted1 = p1, sorted2 = p2;
+        sorted1.normalize();
+        sorted2.normalize();
+        return multiply(sorted1, sorted2);
+    }
+    
+    int vars = p1.variables;
+    MultiPolynomial result(vars);
+    if (p1.terms() == 0 || p2.terms() == 0) {
+        return result;
+    }
+    
+    vector<uint64_t> sizes(vars);
+    double box = 1;
+    for (int v = 0; v < vars; v++) {
+        uint64_t maxDegree = (uint64_t)p1.degreeIn(v) + p2.degreeIn(v);
+        if (maxDegree > p1.maxExponent()) {
+            throw runtime_error("Exponent overflow in product");
+        }
+        sizes[v] = maxDegree + 1;
+        box *= sizes[v];
+    }
+    
+    if (box <= (double)p1.terms() * p2.terms() && box <= (1 << 24)) {
+        auto toIndex = [&](uint64_t monomial) {
+            size_t index = 0;
+            for (int v = vars - 1; v >= 0; v--) {
+                index = index * sizes[v] + p1.exponent(monomial, v);
+            }
+            return index;
+        };
+        
+        // Наибольший индекс множителя - угол его коробки показателей
+        auto cornerIndex = [&](const MultiPolynomial& p) {
+            size_t index = 0;
+            for (int v = vars - 1; v >= 0; v--) {
+                index = index * sizes[v] + p.degreeIn(v);
+            }
+            return index;
+        };
+        
+        vector<double> dense1(cornerIndex(p1) + 1, 0.0);
+        vector<double> dense2(cornerIndex(p2) + 1, 0.0);
+        for (int t = 0; t < p1.terms(); t++) dense1[toIndex(p1.monomials[t])] += p1.coefficients[t];
+        for (int t = 0; t < p2.terms(); t++) dense2[toIndex(p2.monomials[t])] += p2.coefficients[t];
+        
+        vector<double> product = multiplyCoefficients(dense1, dense2);
+        
+        for (size_t index = 0; index < product.size(); index++) {
+            if (abs(product[index]) < 1e-10) continue;
+            
+            uint64_t monomial = 0;
+            size_t rest = index;
+            for (int v = 0; v < vars; v++) {
+                monomial |= (uint64_t)(rest % sizes[v]) << (v * p1.bitsPerVariable());
+                rest /= sizes[v];
+            }
+            result.monomials.push_back(monomial);
+            result.coefficients.push_back(product[index]);
+        }
+        return result;
+    }
+    
+    int parts = min(workerCount(), p1.terms());
+    double expected = min(box, (double)(p1.terms() / parts + 1) * p2.terms());
+    vector<MonomialTable> tables(parts, MonomialTable(min(expected, (double)(1 << 22))));
+    
+    parallelFor(parts, [&](int begin, int end) {
+        for (int part = begin; part < end; part++) {
+            for (int i = part; i < p1.terms(); i += parts) {
+                for (int j = 0; j < p2.terms(); j++) {
+                    tables[part].add(p1.monomials[i] + p2.monomials[j], p1.coefficients[i] * p2.coefficients[j]);
+                }
+            }
+        }
+    }, 1);
+    
+    for (const MonomialTable& table : tables) {
+        table.forEach([&](uint64_t monomial, double coef) {
+            result.monomials.push_back(monomial);
+            result.coefficients.push_back(coef);
+        });
+    }
+    
+    result.normalize();
+    return result;
+}
+
+double evaluate(const MultiPolynomial& p, const vector<double>& point) {
+    double result = 0;
+    for (int t = 0; t < p.terms(); t++) {
+        double term = p.coefficients[t];
+        for (int v = 0; v < p.variables; v++) {
+            int e = p.exponent(p.monomials[t], v);
+            if (e > 0) term *= pow(point[v], e);
+        }
+        result += term;
+    }
+    return result;
+}
+
+// Вычисление в многих точках блоками по 64 точки. По старшей переменной работает схема Горнера,
+// по остальным - таблицы степеней; все внутренние циклы идут по точкам блока и векторизуются.
+// Горнер требует упорядоченных одночленов, поэтому ненормализованный многочлен сначала копируется
+// points[v][k] - координата v точки k
+vector<double> evaluateMany(const MultiPolynomial& p, const vector<vector<double>>& points) {
+    const int BLOCK = 64;
+    if (!p.isNormalized()) {
+        MultiPolynomial sorted = p;
+        sorted.normalize();
+        return evaluateMany(sorted, points);
+    }
+    
+    int count = points.empty() ? 0 : points[0].size();
+    int top = p.variables - 1;
+    vector<double> results(count, 0.0);
+    
+    if (p.terms() == 0) {
+        return results;
     }
     
-    return result;
+    vector<int> degrees(top);
+    for (int v = 0; v < top; v++) {
+        degrees[v] = p.degreeIn(v);
+    }
+    
+    int blocks = (count + BLOCK - 1) / BLOCK;
+    
+    parallelFor(blocks, [&](int beginBlock, int endBlock) {
+        vector<vector<double>> powers(top);
+        double x[BLOCK];
+        double term[BLOCK];
+        double sum[BLOCK];
+        
+        for (int block = beginBlock; block < endBlock; block++) {
+            int offset = block * BLOCK;
+            int size = min(BLOCK, count - offset);
+            
+            fill(x, x + BLOCK, 0.0);
+            copy(points[top].begin() + offset, points[top].begin() + offset + size, x);
+            
+            for (int v = 0; v < top; v++) {
+                powers[v].assign((size_t)(degrees[v] + 1) * BLOCK, 1.0);
+                for (int e = 1; e <= degrees[v]; e++) {
+                    double* current = &powers[v][(size_t)e * BLOCK];
+                    const double* previous = current - BLOCK;
+                    for (int k = 0; k < size; k++) {
+                        current[k] = previous[k] * points[v][offset + k];
+                    }
+                }
+            }
+            
+            fill(sum, sum + BLOCK, 0.0);
+            int previousExponent = p.exponent(p.monomials.back(), top);
+            
+            for (int t = p.terms() - 1; t >= 0; t--) {
+                int e = p.exponent(p.monomials[t], top);
+                for (int shift = e; shift < previousExponent; shift++) {
+                    for (int k = 0; k < BLOCK; k++) sum[k] *= x[k];
+                }
+                previousExponent = e;
+                
+                uint64_t rest = top == 0 ? 0 : p.monomials[t] & ((1ULL << (top * p.bitsPerVariable())) - 1);
+                if (rest == 0) {
+                    double coef = p.coefficients[t];
+                    for (int k = 0; k < BLOCK; k++) sum[k] += coef;
+                    continue;
+                }
+                
+                fill(term, term + BLOCK, p.coefficients[t]);
+                for (int v = 0; v < top; v++) {
+                    int exponent = p.exponent(rest, v);
+                    if (exponent == 0) continue;
+                    const double* power = &powers[v][(size_t)exponent * BLOCK];
+                    for (int k = 0; k < BLOCK; k++) term[k] *= power[k];
+                }
+                for (int k = 0; k < BLOCK; k++) sum[k] += term[k];
+            }
+            
+            for (int shift = 0; shift < previousExponent; shift++) {
+                for (int k = 0; k < BLOCK; k++) sum[k] *= x[k];
+            }
+            
+            copy(sum, sum + size, results.begin() + offset);
+        }
+    }, 2);
+    
+    return results;
 }
 
 Polynomial inputPolynomial() {
@@ -165,6 +1230,149 @@ Polynomial inputPolynomial() {
     return p;
 }
 
+// Бинарный формат: "POLY", версия, число коэффициентов, затем коэффициенты double от свободного члена
+const char POLY_MAGIC[4] = {'P', 'O', 'L', 'Y'};
+const uint32_t POLY_VERSION = 1;
+
+struct PolyHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t count;
+};
+
+bool isBinaryFile(const string& filename) {
+    ifstream file(filename, ios::binary);
+    char magic[4] = {};
+    file.read(magic, sizeof(magic));
+    return file && memcmp(magic, POLY_MAGIC, sizeof(magic)) == 0;
+}
+
+Polynomial fromRawCoefficients(const double* data, size_t count) {
+    if (count == 0) {
+        throw runtime_error("Polynomial file has no coefficients");
+    }
+    return Polynomial(vector<double>(data, data + count));
+}
+
+// Бинарный файл отображается в память и копируется одним проходом без поэлементного чтения
+Polynomial loadBinaryPolynomial(const string& filename) {
+#ifndef _WIN32
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw runtime_error("Cannot open file: " + filename);
+    }
+    
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(PolyHeader)) {
+        close(fd);
+        throw runtime_error("Invalid polynomial file: " + filename);
+    }
+    
+    void* mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        throw runtime_error("Cannot map file: " + filename);
+    }
+    
+    PolyHeader header;
+    memcpy(&header, mapped, sizeof(header));
+    size_t available = (info.st_size - sizeof(PolyHeader)) / sizeof(double);
+    
+    if (header.version != POLY_VERSION || header.count > available) {
+        munmap(mapped, info.st_size);
+        throw runtime_error("Invalid polynomial file: " + filename);
+    }
+    
+    madvise(mapped, info.st_size, MADV_SEQUENTIAL);
+    const double* data = reinterpret_cast<const double*>(static_cast<const char*>(mapped) + sizeof(PolyHeader));
+    
+    try {
+        Polynomial result = fromRawCoefficients(data, header.count);
+        munmap(mapped, info.st_size);
+        return result;
+    } catch (...) {
+        munmap(mapped, info.st_size);
+        throw;
+    }
+#else
+    ifstream file(filename, ios::binary);
+    PolyHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.version != POLY_VERSION) {
+        throw runtime_error("Invalid polynomial file: " + filename);
+    }
+    
+    vector<double> coefs(header.count);
+    if (!file.read(reinterpret_cast<char*>(coefs.data()), coefs.size() * sizeof(double))) {
+        throw runtime_error("Invalid polynomial file: " + filename);
+    }
+    return fromRawCoefficients(coefs.data(), coefs.size());
+#endif
+}
+
+// Текстовый формат: коэффициенты от свободного члена через пробелы или переводы строк
+Polynomial loadTextPolynomial(const string& filename) {
+    ifstream file(filename, ios::binary);
+    if (!file) {
+        throw runtime_error("Cannot open file: " + filename);
+    }
+    
+    string content((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    vector<double> coefs;
+    const char* current = content.c_str();
+    char* end;
+    
+    while (true) {
+        double value = strtod(current, &end);
+        if (end == current) break;
+        coefs.push_back(value);
+        current = end;
+    }
+    
+    while (*current != '\0' && isspace((unsigned char)*current)) current++;
+    if (*current != '\0') {
+        throw runtime_error("Invalid number in file: " + filename);
+    }
+    
+    return fromRawCoefficients(coefs.data(), coefs.size());
+}
+
+Polynomial loadPolynomial(const string& filename) {
+    return isBinaryFile(filename) ? loadBinaryPolynomial(filename) : loadTextPolynomial(filename);
+}
+
+void savePolynomial(const Polynomial& p, const string& filename, bool binary) {
+    ofstream file(filename, ios::binary);
+    if (!file) {
+        throw runtime_error("Cannot create file: " + filename);
+    }
+    
+    if (binary) {
+        PolyHeader header;
+        memcpy(header.magic, POLY_MAGIC, sizeof(POLY_MAGIC));
+        header.version = POLY_VERSION;
+        header.count = p.coefficients.size();
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(p.coefficients.data()), p.coefficients.size() * sizeof(double));
+    } else {
+        // Весь текст собирается в буфер и пишется одним вызовом
+        string buffer;
+        char number[32];
+        for (double c : p.coefficients) {
+            int length = snprintf(number, sizeof(number), "%.17g\n", c);
+            buffer.append(number, length);
+        }
+        file.write(buffer.data(), buffer.size());
+    }
+    
+    if (!file) {
+        throw runtime_error("Cannot write file: " + filename);
+    }
+}
+
+bool hasTextExtension(const string& filename) {
+    return filename.size() >= 4 && filename.compare(filename.size() - 4, 4, ".txt") == 0;
+}
+
 void createTestPolynomials(Polynomial& p1, Polynomial& p2) {
 
     p1.coefficients = {1, -5, 3, 2};
@@ -214,6 +1422,379 @@ void demonstrateHorner(const Polynomial& p, double x) {
     cout << "Результат (прямой):  " << fixed << setprecision(6) << direct << endl;
     cout << "Разница:             " << scientific << setprecision(2) 
          << abs(current - direct) << endl;
+    
+    EvaluationResult plain = evaluateHornerWithBound(p, x);
+    EvaluationResult compensated = evaluateCompensated(p, x);
+    cout << "Оценка погрешности Горнера:       " << plain.errorBound << endl;
+    cout << "Результат (компенсированный):     " << fixed << setprecision(6) << compensated.value << endl;
+    cout << "Оценка погрешности (компенс.):    " << scientific << setprecision(2)
+         << compensated.errorBound << defaultfloat << endl;
+}
+
+// Старший коэффициент больше суммы остальных: все корни внутри единичного круга,
+// поэтому частные при делении не растут экспоненциально
+Polynomial randomPolynomial(int degree, mt19937& rng) {
+    uniform_real_distribution<double> dist(-1.0, 1.0);
+    vector<double> coefs(degree + 1);
+    for (double& c : coefs) {
+        c = dist(rng);
+    }
+    coefs[degree] = degree + 1.0;
+    return Polynomial(coefs);
+}
+
+template <typename Func>
+double measureMs(Func action) {
+    auto start = chrono::steady_clock::now();
+    action();
+    auto finish = chrono::steady_clock::now();
+    return chrono::duration<double, milli>(finish - start).count();
+}
+
+void runDivisionBenchmark() {
+    cout << "\n╔════════════════════════════════════════╗" << endl;
+    cout << "║   БЕНЧМАРК: ДЕЛЕНИЕ, НОД, КОРНИ       ║" << endl;
+    cout << "╚════════════════════════════════════════╝" << endl;
+    cout << "Потоков: " << max(1u, thread::hardware_concurrency()) << endl;
+    
+    mt19937 rng(12345);
+    
+    cout << "\n--- Деление (степень 2n на степень n) ---" << endl;
+    cout << "       n     столбик, мс      Ньютон, мс    коэф./с (Ньютон)" << endl;
+    
+    for (int n : {1000, 10000, 100000}) {
+        Polynomial a = randomPolynomial(2 * n, rng);
+        Polynomial b = randomPolynomial(n, rng);
+        Polynomial remainder;
+        
+        cout << setw(8) << n;
+        if (n <= 10000) {
+            double longMs = measureMs([&] { divide(a, b, remainder); });
+            cout << setw(16) << fixed << setprecision(2) << longMs;
+        } else {
+            cout << setw(16) << "-";
+        }
+        
+        double fastMs = measureMs([&] { divideFast(a, b, remainder); });
+        cout << setw(16) << fixed << setprecision(2) << fastMs
+             << setw(20) << scientific << setprecision(2) << (3.0 * n) / (fastMs / 1000) << endl;
+    }
+    
+    cout << "\n--- НОД (общий множитель степени n/2) ---" << endl;
+    cout << "       n       время, мс     степень НОД       ожидалась" << endl;
+    
+    for (int n : {50, 100, 200}) {
+        Polynomial common = randomPolynomial(n / 2, rng);
+        Polynomial a = multiplyFast(common, randomPolynomial(n / 2, rng));
+        Polynomial b = multiplyFast(common, randomPolynomial(n / 2 - 1, rng));
+        Polynomial result;
+        
+        double ms = measureMs([&] { result = gcd(a, b); });
+        cout << setw(8) << n << setw(16) << fixed << setprecision(2) << ms
+             << setw(16) << result.degree() << setw(16) << common.degree();
+        if (result.degree() != common.degree()) {
+            cout << "  ОШИБКА";
+        }
+        cout << endl;
+    }
+    
+    cout << "\n--- Корни (Эрлих-Аберт) ---" << endl;
+    cout << "       n       время, мс            корней/с" << endl;
+    
+    for (int n : {100, 1000, 2000}) {
+        Polynomial p = randomPolynomial(n, rng);
+        double ms = measureMs([&] { findRoots(p); });
+        cout << setw(8) << n << setw(16) << fixed << setprecision(2) << ms
+             << setw(20) << scientific << setprecision(2) << n / (ms / 1000) << endl;
+    }
+    cout << defaultfloat;
+}
+
+void runFixedPolynomialBenchmark(const Polynomial& p, double x) {
+    cout << "\n╔════════════════════════════════════════╗" << endl;
+    cout << "║   МНОГОЧЛЕНЫ ФИКСИРОВАННОЙ СТЕПЕНИ    ║" << endl;
+    cout << "╚════════════════════════════════════════╝" << endl;
+    
+    if (p.degree() <= 12) {
+        FixedPolynomial<12> fixedP = FixedPolynomial<12>::fromPolynomial(p);
+        cout << "P1(" << x << "):" << endl;
+        cout << "  Polynomial, Горнер:      " << fixed << setprecision(6) << evaluateHorner(p, x) << endl;
+        cout << "  FixedPolynomial, Горнер: " << evaluateHorner(fixedP, x) << endl;
+        cout << "  FixedPolynomial, Эстрин: " << evaluateEstrin(fixedP, x) << endl;
+    } else {
+        cout << "Степень P1 больше 12, сравнение значений пропущено." << endl;
+    }
+    
+    constexpr FixedPolynomial<8> expKernel = taylorExp<8>();
+    Polynomial dynamicKernel = expKernel.toPolynomial();
+    
+    const int count = 1 << 20;
+    const int repeats = 20;
+    vector<double> points(count);
+    mt19937 rng(12345);
+    uniform_real_distribution<double> dist(-0.5, 0.5);
+    for (double& point : points) {
+        point = dist(rng);
+    }
+    
+    double checksum = 0;
+    auto report = [&](const string& name, double ms) {
+        cout << "  " << name << fixed << setprecision(2)
+             << ms * 1e6 / ((double)count * repeats) << " нс/вызов" << endl;
+    };
+    
+    cout << "\nЯдро exp(x), степень 8, " << count << " точек x " << repeats << " повторов:" << endl;
+    
+    report("Polynomial, Горнер:      ", measureMs([&] {
+        for (int r = 0; r < repeats; r++)
+            for (double point : points) checksum += evaluateHorner(dynamicKernel, point);
+    }));
+    report("Polynomial, прямой:      ", measureMs([&] {
+        for (int r = 0; r < repeats; r++)
+            for (double point : points) checksum += evaluateDirect(dynamicKernel, point);
+    }));
+    report("FixedPolynomial, Горнер: ", measureMs([&] {
+        for (int r = 0; r < repeats; r++)
+            for (double point : points) checksum += expKernel.evaluateHorner(point);
+    }));
+    report("FixedPolynomial, Эстрин: ", measureMs([&] {
+        for (int r = 0; r < repeats; r++)
+            for (double point : points) checksum += expKernel.evaluateEstrin(point);
+    }));
+    
+    cout << "Контрольная сумма: " << scientific << setprecision(6) << checksum << defaultfloat << endl;
+}
+
+void runAccuracyBenchmark() {
+    cout << "\n╔════════════════════════════════════════╗" << endl;
+    cout << "║   ТОЧНОСТЬ И СКОРОСТЬ ВЫЧИСЛЕНИЯ      ║" << endl;
+    cout << "╚════════════════════════════════════════╝" << endl;
+    
+    double checksum = 0;
+    
+    // (x - 1)^n в развернутом виде: плохо обусловлен вблизи x = 1, точное значение известно
+    for (int n : {5, 8, 12}) {
+        Polynomial p(vector<double>{1.0});
+        for (int k = 0; k < n; k++) {
+            p = multiply(p, Polynomial(vector<double>{-1.0, 1.0}));
+        }
+        
+        const int count = 1 << 16;
+        vector<double> points(count);
+        for (int i = 0; i < count; i++) {
+            double offset = 0.005 + 0.045 * (i / 2) / (count / 2);
+            points[i] = i % 2 == 0 ? 1.0 + offset : 1.0 - offset;
+        }
+        
+        cout << "\n(x - 1)^" << n << ", 0.005 <= |x - 1| <= 0.05:" << endl;
+        cout << "  метод                 макс. отн. ошибка  макс. отн. оценка   нс/вызов" << endl;
+        
+        auto row = [&](const string& name, auto method) {
+            double maxError = 0, maxBound = 0;
+            for (double x : points) {
+                EvaluationResult r = method(p, x);
+                
+                // x - 1 вычисляется точно, степень считаем в double-double
+                DoubleDouble power = {1.0, 0.0};
+                for (int k = 0; k < n; k++) {
+                    power = multiply(power, x - 1.0);
+                }
+                double exact = power.hi + power.lo;
+                maxError = max(maxError, abs((r.value - power.hi) - power.lo) / abs(exact));
+                maxBound = max(maxBound, r.errorBound / abs(exact));
+            }
+            
+            double ms = measureMs([&] {
+                for (double x : points) checksum += method(p, x).value;
+            });
+            
+            cout << "  " << name << scientific << setprecision(2)
+                 << setw(19) << maxError << setw(19) << maxBound
+                 << setw(11) << fixed << ms * 1e6 / count << endl;
+        };
+        
+        row("Горнер              ", evaluateHornerWithBound);
+        row("компенсированный    ", evaluateCompensated);
+        row("double-double       ", evaluateDoubleDouble);
+        row("адаптивный (1e-8)   ", [](const Polynomial& poly, double x) {
+            return evaluateAdaptive(poly, x, 1e-8);
+        });
+    }
+    
+    cout << "\nКонтрольная сумма: " << scientific << setprecision(6) << checksum << endl;
+    cout << defaultfloat;
+}
+
+Polynomial sparsePolynomial(int degree, double density, mt19937& rng) {
+    uniform_real_distribution<double> dist(-1.0, 1.0);
+    bernoulli_distribution present(density);
+    vector<double> coefs(degree + 1, 0.0);
+    for (double& c : coefs) {
+        if (present(rng)) c = dist(rng);
+    }
+    coefs[degree] = 1.0;
+    return Polynomial(coefs);
+}
+
+// Повторяет действие, удваивая число повторов, пока замер не займет хотя бы 20 мс
+template <typename Func>
+double measureNsPerOp(Func action) {
+    for (long long repeats = 1; ; repeats *= 2) {
+        double ms = measureMs([&] {
+            for (long long r = 0; r < repeats; r++) action();
+        });
+        if (ms >= 20 || repeats >= (1LL << 30)) {
+            return ms * 1e6 / repeats;
+        }
+    }
+}
+
+void printBenchmarkRow(int degree, double density, const string& operation, double ns, double flops) {
+    cout << setw(9) << degree << setw(8) << fixed << setprecision(2) << density
+         << "  " << left << setw(14) << operation << right
+         << setw(16) << setprecision(1) << ns
+         << setw(10) << setprecision(3) << flops / ns << endl;
+}
+
+void runOperationsBenchmark() {
+    cout << "\n╔════════════════════════════════════════╗" << endl;
+    cout << "║   БЕНЧМАРК ОПЕРАЦИЙ                   ║" << endl;
+    cout << "╚════════════════════════════════════════╝" << endl;
+    cout << "  степень  плотн.  операция                нс/оп   GFLOP/s" << endl;
+    
+    mt19937 rng(12345);
+    double sink = 0;
+    
+    for (int degree : {10, 100, 1000, 10000, 100000, 1000000}) {
+        for (double density : {1.0, 0.1, 0.01}) {
+            Polynomial a = sparsePolynomial(degree, density, rng);
+            Polynomial b = sparsePolynomial(degree, density, rng);
+            double n = degree + 1;
+            
+            printBenchmarkRow(degree, density, "add", measureNsPerOp([&] {
+                sink += add(a, b).coefficients[0];
+            }), n);
+            
+            if (degree <= 10000) {
+                printBenchmarkRow(degree, density, "multiply", measureNsPerOp([&] {
+                    sink += multiply(a, b).coefficients[0];
+                }), 2 * n * n);
+            }
+            
+            // Оценка числа операций для трех БПФ длины size: 5 size log2(size) каждое
+            double size = 1;
+            while (size < 2 * n) size *= 2;
+            printBenchmarkRow(degree, density, "multiplyFast", measureNsPerOp([&] {
+                sink += multiplyFast(a, b).coefficients[0];
+            }), n * n < 262144 ? 2 * n * n : 15 * size * log2(size) + 6 * size);
+            
+            printBenchmarkRow(degree, density, "Horner", measureNsPerOp([&] {
+                sink += evaluateHorner(a, 0.999);
+            }), 2 * n);
+            
+            printBenchmarkRow(degree, density, "direct", measureNsPerOp([&] {
+                sink += evaluateDirect(a, 0.999);
+            }), 3 * n);
+        }
+    }
+    
+    cout << "\n--- Файловый ввод-вывод, 10^6 коэффициентов ---" << endl;
+    Polynomial big = sparsePolynomial(999999, 1.0, rng);
+    
+    for (bool binary : {true, false}) {
+        string filename = binary ? "bench_poly.bin" : "bench_poly.txt";
+        double saveMs = measureMs([&] { savePolynomial(big, filename, binary); });
+        double loadMs = measureMs([&] { sink += loadPolynomial(filename).coefficients[0]; });
+        remove(filename.c_str());
+        
+        cout << (binary ? "  бинарный: " : "  текстовый: ") << fixed << setprecision(2)
+             << "запись " << saveMs << " мс, чтение " << loadMs << " мс" << endl;
+    }
+    
+    cout << "Контрольная сумма: " << scientific << setprecision(6) << sink << defaultfloat << endl;
+}
+
+MultiPolynomial randomMultiPolynomial(int variables, int terms, int maxExponent, mt19937& rng) {
+    uniform_real_distribution<double> dist(-1.0, 1.0);
+    uniform_int_distribution<int> exponentDist(0, maxExponent);
+    MultiPolynomial result(variables);
+    vector<int> exponents(variables);
+    
+    for (int t = 0; t < terms; t++) {
+        for (int& e : exponents) e = exponentDist(rng);
+        result.addTerm(exponents, dist(rng));
+    }
+    
+    result.normalize();
+    return result;
+}
+
+void runMultivariateDemo() {
+    cout << "\n╔════════════════════════════════════════╗" << endl;
+    cout << "║   МНОГОЧЛЕНЫ ОТ НЕСКОЛЬКИХ ПЕРЕМЕННЫХ ║" << endl;
+    cout << "╚════════════════════════════════════════╝" << endl;
+    
+    MultiPolynomial linear(3);
+    linear.addTerm({0, 0, 0}, 1);
+    linear.addTerm({1, 0, 0}, 1);
+    linear.addTerm({0, 1, 0}, 1);
+    linear.addTerm({0, 0, 1}, 1);
+    linear.normalize();
+    
+    MultiPolynomial square = multiply(linear, linear);
+    cout << "Q = ";
+    linear.display();
+    cout << endl;
+    cout << "Q^2 = ";
+    square.display();
+    cout << endl;
+    cout << "Q^2(1, 2, 3) = " << evaluate(square, {1, 2, 3}) << endl;
+    
+    mt19937 rng(12345);
+    double sink = 0;
+    
+    cout << "\n--- Умножение (хеш-таблицы, потоков: " << workerCount() << ") ---" << endl;
+    cout << "  перем.   термов  результат       время, мс    произв./с" << endl;
+    
+    for (int vars : {3, 5, 8}) {
+        for (int terms : {1000, 2000}) {
+            MultiPolynomial a = randomMultiPolynomial(vars, terms, 12, rng);
+            MultiPolynomial b = randomMultiPolynomial(vars, terms, 12, rng);
+            MultiPolynomial product;
+            
+            double ms = measureMs([&] { product = multiply(a, b); });
+            cout << setw(8) << vars << setw(9) << a.terms() << setw(11) << product.terms()
+                 << setw(16) << fixed << setprecision(2) << ms
+                 << setw(13) << scientific << setprecision(2) << (double)a.terms() * b.terms() / (ms / 1000)
+                 << endl;
+        }
+    }
+    
+    cout << "\n--- Одна переменная: сравнение с Polynomial ---" << endl;
+    const int degree = 10000;
+    const int pointCount = 20000;
+    Polynomial dense = randomPolynomial(degree, rng);
+    MultiPolynomial multi = MultiPolynomial::fromPolynomial(dense);
+    
+    double denseMs = measureMs([&] { sink += multiplyFast(dense, dense).coefficients[0]; });
+    double multiMs = measureMs([&] { sink += multiply(multi, multi).coefficients[0]; });
+    cout << "Умножение, степень " << degree << ": Polynomial " << fixed << setprecision(2) << denseMs
+         << " мс, MultiPolynomial " << multiMs << " мс" << endl;
+    
+    vector<vector<double>> points(1, vector<double>(pointCount));
+    uniform_real_distribution<double> dist(-1.0, 1.0);
+    for (double& x : points[0]) x = dist(rng);
+    
+    denseMs = measureMs([&] {
+        for (double x : points[0]) sink += evaluateHorner(dense, x);
+    });
+    multiMs = measureMs([&] {
+        for (double value : evaluateMany(multi, points)) sink += value;
+    });
+    cout << "Вычисление в " << pointCount << " точках: Горнер " << denseMs
+         << " мс, evaluateMany " << multiMs << " мс" << endl;
+    
+    cout << "Контрольная сумма: " << scientific << setprecision(6) << sink << defaultfloat << endl;
 }
 
 void displayMenu() {
@@ -230,15 +1811,87 @@ void displayMenu() {
     cout << "8.  Вычислить значение P2(x)" << endl;
     cout << "9.  Демонстрация схемы Горнера" << endl;
     cout << "10. Создать тестовые многочлены" << endl;
+    cout << "11. Разделить многочлены (P1 / P2)" << endl;
+    cout << "12. НОД многочленов" << endl;
+    cout << "13. Найти корни P1" << endl;
+    cout << "14. Бенчмарк деления, НОД и корней" << endl;
+    cout << "15. Многочлены фиксированной степени" << endl;
+    cout << "16. Точность: компенсированный Горнер и double-double" << endl;
+    cout << "17. Загрузить многочлен из файла" << endl;
+    cout << "18. Сохранить многочлен в файл" << endl;
+    cout << "19. Бенчмарк операций" << endl;
+    cout << "20. Многочлены от нескольких переменных" << endl;
     cout << "0.  Выход" << endl;
     cout << "───────────────────────────────────────" << endl;
     cout << "Выберите действие: ";
 }
 
-int main() {
+void printBatchUsage() {
+    cerr << "Использование:" << endl;
+    cerr << "  lvl1proj5 add|sub|mul <A> <B> <OUT>" << endl;
+    cerr << "  lvl1proj5 div <A> <B> <QUOTIENT> <REMAINDER>" << endl;
+    cerr << "  lvl1proj5 eval <A> <x>..." << endl;
+    cerr << "  lvl1proj5 roots <A>" << endl;
+    cerr << "  lvl1proj5 convert <IN> <OUT>" << endl;
+    cerr << "  lvl1proj5 bench" << endl;
+    cerr << "Файлы *.txt - текстовые, остальные - бинарные." << endl;
+}
+
+void saveByExtension(const Polynomial& p, const string& filename) {
+    savePolynomial(p, filename, !hasTextExtension(filename));
+}
+
+// Пакетный режим: операции над файлами без интерактивного меню
+int runBatch(int argc, char* argv[]) {
+    string command = argv[1];
+    vector<string> args(argv + 2, argv + argc);
+    
+    try {
+        if ((command == "add" || command == "sub" || command == "mul") && args.size() == 3) {
+            Polynomial a = loadPolynomial(args[0]);
+            Polynomial b = loadPolynomial(args[1]);
+            Polynomial result = command == "add" ? add(a, b)
+                              : command == "sub" ? subtract(a, b)
+                              : multiplyFast(a, b);
+            saveByExtension(result, args[2]);
+        } else if (command == "div" && args.size() == 4) {
+            Polynomial remainder;
+            Polynomial quotient = divideFast(loadPolynomial(args[0]), loadPolynomial(args[1]), remainder);
+            saveByExtension(quotient, args[2]);
+            saveByExtension(remainder, args[3]);
+        } else if (command == "eval" && args.size() >= 2) {
+            Polynomial a = loadPolynomial(args[0]);
+            for (size_t i = 1; i < args.size(); i++) {
+                cout << setprecision(17) << evaluateHorner(a, stod(args[i])) << "\n";
+            }
+        } else if (command == "roots" && args.size() == 1) {
+            for (const complex<double>& root : findRoots(loadPolynomial(args[0]))) {
+                cout << setprecision(17) << root.real() << " " << root.imag() << "\n";
+            }
+        } else if (command == "convert" && args.size() == 2) {
+            saveByExtension(loadPolynomial(args[0]), args[1]);
+        } else if (command == "bench" && args.empty()) {
+            runOperationsBenchmark();
+        } else {
+            printBatchUsage();
+            return 2;
+        }
+    } catch (const exception& e) {
+        cerr << "✗ ОШИБКА: " << e.what() << endl;
+        return 1;
+    }
+    
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
 
     system("chcp 65001 > nul");
     
+    if (argc > 1) {
+        return runBatch(argc, argv);
+    }
+    
     Polynomial p1, p2;
     int choice;
     
@@ -367,6 +2020,124 @@ int main() {
                 createTestPolynomials(p1, p2);
                 break;
                 
+            case 11: {
+                cout << "\n=== Деление ===" << endl;
+                cout << "P1(x) = ";
+                p1.display();
+                cout << endl;
+                cout << "P2(x) = ";
+                p2.display();
+                cout << endl;
+                
+                if (isZero(p2)) {
+                    cout << "Деление на нулевой многочлен невозможно!" << endl;
+                    break;
+                }
+                
+                Polynomial remainder;
+                Polynomial quotient = divideFast(p1, p2, remainder);
+                cout << "───────────────────────────────────────" << endl;
+                cout << "Частное:  ";
+                quotient.display();
+                cout << endl;
+                cout << "Остаток:  ";
+                remainder.display();
+                cout << endl;
+                break;
+            }
+                
+            case 12: {
+                cout << "\n=== НОД ===" << endl;
+                Polynomial common = gcd(p1, p2);
+                cout << "НОД(P1, P2) = ";
+                common.display();
+                cout << endl;
+                break;
+            }
+                
+            case 13: {
+                cout << "\n=== Корни P1 ===" << endl;
+                cout << "P1(x) = ";
+                p1.display();
+                cout << endl;
+                
+                vector<complex<double>> roots = findRoots(p1);
+                if (roots.empty()) {
+                    cout << "У многочлена нулевой степени нет корней." << endl;
+                    break;
+                }
+                
+                cout << "───────────────────────────────────────" << endl;
+                for (size_t i = 0; i < roots.size(); i++) {
+                    cout << "x" << i + 1 << " = " << fixed << setprecision(6) << roots[i].real();
+                    if (abs(roots[i].imag()) > 1e-9) {
+                        cout << (roots[i].imag() > 0 ? " + " : " - ") << abs(roots[i].imag()) << "i";
+                    }
+                    cout << endl;
+                }
+                break;
+            }
+                
+            case 14:
+                runDivisionBenchmark();
+                break;
+                
+            case 15: {
+                double x;
+                cout << "\nВведите значение x: ";
+                cin >> x;
+                
+                runFixedPolynomialBenchmark(p1, x);
+                break;
+            }
+                
+            case 16:
+                runAccuracyBenchmark();
+                break;
+                
+            case 17:
+            case 18: {
+                int polyChoice;
+                string filename;
+                cout << "\nВыберите многочлен (1 - P1, 2 - P2): ";
+                cin >> polyChoice;
+                cout << "Имя файла (.txt - текст, иначе бинарный): ";
+                cin >> filename;
+                
+                if (polyChoice != 1 && polyChoice != 2) {
+                    cout << "Неверный выбор!" << endl;
+                    break;
+                }
+                
+                Polynomial& target = polyChoice == 1 ? p1 : p2;
+                
+                try {
+                    if (choice == 17) {
+                        target = loadPolynomial(filename);
+                        cout << "✓ Загружен многочлен степени " << target.degree() << endl;
+                        if (target.degree() <= 20) {
+                            cout << "P" << polyChoice << "(x) = ";
+                            target.display();
+                            cout << endl;
+                        }
+                    } else {
+                        savePolynomial(target, filename, !hasTextExtension(filename));
+                        cout << "✓ Многочлен сохранен в " << filename << endl;
+                    }
+                } catch (const exception& e) {
+                    cout << "✗ ОШИБКА: " << e.what() << endl;
+                }
+                break;
+            }
+                
+            case 19:
+                runOperationsBenchmark();
+                break;
+                
+            case 20:
+                runMultivariateDemo();
+                break;
+                
             case 0:
                 cout << "\nДо свидания!" << endl;
                 break;
@@ -1,124 +1,1162 @@
 #include <iostream>
 #include <cstdlib>
-#include <ctime>
 #include <iomanip>
+#include <vector>
+#include <bitset>
+#include <cstdint>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <sstream>
+#include <unordered_map>
+#include <fstream>
+#include <mutex>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
 
 using namespace std;
 
-class Minesweeper {
+// Битовая доска: по биту на клетку, каждая строка занимает целое число 64-битных слов,
+// столбец c лежит в бите c % 64 слова c / 64
+class BitBoard {
+private:
+    int rows = 0;
+    int cols = 0;
+    int wordsPerRow = 0;
+    vector<uint64_t> words;
+    
+    size_t index(int row, int col) const {
+        return (size_t)row * wordsPerRow + (col >> 6);
+    }
+    
+public:
+    BitBoard() {}
+    
+    BitBoard(int r, int c) : rows(r), cols(c), wordsPerRow((c + 63) / 64), words((size_t)r * wordsPerRow, 0) {}
+    
+    bool test(int row, int col) const {
+        return words[index(row, col)] >> (col & 63) & 1;
+    }
+    
+    void set(int row, int col) {
+        words[index(row, col)] |= (uint64_t)1 << (col & 63);
+    }
+    
+    void reset(int row, int col) {
+        words[index(row, col)] &= ~((uint64_t)1 << (col & 63));
+    }
+    
+    void flip(int row, int col) {
+        words[index(row, col)] ^= (uint64_t)1 << (col & 63);
+    }
+    
+    void clear() {
+        fill(words.begin(), words.end(), 0);
+    }
+    
+    int count() const {
+        int total = 0;
+        for (uint64_t word : words) total += bitset<64>(word).count();
+        return total;
+    }
+    
+    int rowWords() const {
+        return wordsPerRow;
+    }
+    
+    uint64_t* row(int r) {
+        return &words[(size_t)r * wordsPerRow];
+    }
+    
+    const uint64_t* row(int r) const {
+        return &words[(size_t)r * wordsPerRow];
+    }
+    
+    // Биты слова w, соответствующие реальным столбцам
+    uint64_t columnMask(int w) const {
+        int used = cols - w * 64;
+        return used >= 64 ? ~(uint64_t)0 : ((uint64_t)1 << used) - 1;
+    }
+    
+    // Упаковка для файлов: каждая строка - (cols + 7) / 8 байт, младший бит - меньший столбец
+    void pack(string& out) const {
+        int bytesPerRow = (cols + 7) / 8;
+        for (int r = 0; r < rows; r++) {
+            const uint64_t* line = row(r);
+            for (int k = 0; k < bytesPerRow; k++) out += (char)(line[k / 8] >> (8 * (k % 8)) & 0xFF);
+        }
+    }
+    
+    bool unpack(const string& in, size_t& pos) {
+        int bytesPerRow = (cols + 7) / 8;
+        if (in.size() - pos < (size_t)rows * bytesPerRow) return false;
+        clear();
+        for (int r = 0; r < rows; r++) {
+            uint64_t* line = row(r);
+            for (int k = 0; k < bytesPerRow; k++) line[k / 8] |= (uint64_t)(uint8_t)in[pos++] << (8 * (k % 8));
+            line[wordsPerRow - 1] &= columnMask(wordsPerRow - 1);
+        }
+        return true;
+    }
+};
+
+// Число мин вокруг каждой клетки в виде четырех битовых плоскостей (биты 1, 2, 4 и 8 счетчика).
+// Восемь сдвинутых копий соседних строк складываются побитовым сумматором сразу по 64 клетки
+void countNeighbors(const BitBoard& mines, int rows, BitBoard planes[4]) {
+    int wordsPerRow = mines.rowWords();
+    
+    for (int r = 0; r < rows; r++) {
+        for (int w = 0; w < wordsPerRow; w++) {
+            uint64_t b0 = 0, b1 = 0, b2 = 0, b3 = 0;
+            
+            auto add = [&](uint64_t plane) {
+                uint64_t c0 = b0 & plane;
+                b0 ^= plane;
+                uint64_t c1 = b1 & c0;
+                b1 ^= c0;
+                uint64_t c2 = b2 & c1;
+                b2 ^= c1;
+                b3 |= c2;
+            };
+            
+            for (int dr = -1; dr <= 1; dr++) {
+                if (r + dr < 0 || r + dr >= rows) continue;
+                
+                const uint64_t* source = mines.row(r + dr);
+                uint64_t center = source[w];
+                uint64_t west = center << 1 | (w > 0 ? source[w - 1] >> 63 : 0);
+                uint64_t east = center >> 1 | (w + 1 < wordsPerRow ? source[w + 1] << 63 : 0);
+                
+                add(west);
+                add(east);
+                if (dr != 0) add(center);
+            }
+            
+            uint64_t mask = mines.columnMask(w);
+            planes[0].row(r)[w] = b0 & mask;
+            planes[1].row(r)[w] = b1 & mask;
+            planes[2].row(r)[w] = b2 & mask;
+            planes[3].row(r)[w] = b3 & mask;
+        }
+    }
+}
+
+uint64_t reverseBits(uint64_t x) {
+    x = (x >> 1 & 0x5555555555555555ULL) | (x & 0x5555555555555555ULL) << 1;
+    x = (x >> 2 & 0x3333333333333333ULL) | (x & 0x3333333333333333ULL) << 2;
+    x = (x >> 4 & 0x0F0F0F0F0F0F0F0FULL) | (x & 0x0F0F0F0F0F0F0F0FULL) << 4;
+    x = (x >> 8 & 0x00FF00FF00FF00FFULL) | (x & 0x00FF00FF00FF00FFULL) << 8;
+    x = (x >> 16 & 0x0000FFFF0000FFFFULL) | (x & 0x0000FFFF0000FFFFULL) << 16;
+    return x >> 32 | x << 32;
+}
+
+// Биты mask, лежащие в одном отрезке строки с битом seeds и не ниже его (seeds входят в mask).
+// Сложение mask + seeds пробегает переносом по отрезку, перенос переходит между словами
+void fillRunsUp(const uint64_t* mask, const uint64_t* seeds, uint64_t* out, int words) {
+    uint64_t carry = 0;
+    for (int w = 0; w < words; w++) {
+        uint64_t partial = mask[w] + seeds[w];
+        uint64_t sum = partial + carry;
+        uint64_t carryIn = sum ^ mask[w] ^ seeds[w];
+        carry = (partial < mask[w]) | (sum < partial);
+        out[w] = (carryIn | seeds[w]) & mask[w];
+    }
+}
+
+// Целые отрезки mask, содержащие seeds: заливка вверх и, на развернутой строке, вниз
+void fillRuns(const uint64_t* mask, const uint64_t* seeds, uint64_t* out, int words, vector<uint64_t>& scratch) {
+    fillRunsUp(mask, seeds, out, words);
+    
+    scratch.resize(3 * words);
+    uint64_t* reversedMask = scratch.data();
+    uint64_t* reversedSeeds = reversedMask + words;
+    uint64_t* reversedOut = reversedSeeds + words;
+    for (int w = 0; w < words; w++) {
+        reversedMask[w] = reverseBits(mask[words - 1 - w]);
+        reversedSeeds[w] = reverseBits(seeds[words - 1 - w]);
+    }
+    fillRunsUp(reversedMask, reversedSeeds, reversedOut, words);
+    for (int w = 0; w < words; w++) {
+        out[words - 1 - w] |= reverseBits(reversedOut[w]);
+    }
+}
+
+// Генератор xoshiro256**: состояние из четырех слов, заполняется из зерна через splitmix64
+class Xoshiro256 {
+private:
+    uint64_t state[4];
+    
+    static uint64_t rotl(uint64_t x, int k) {
+        return x << k | x >> (64 - k);
+    }
+    
+public:
+    explicit Xoshiro256(uint64_t seed = 0) {
+        for (uint64_t& word : state) {
+            seed += 0x9E3779B97F4A7C15ULL;
+            uint64_t z = seed;
+            z = (z ^ z >> 30) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ z >> 27) * 0x94D049BB133111EBULL;
+            word = z ^ z >> 31;
+        }
+    }
+    
+    uint64_t next() {
+        uint64_t result = rotl(state[1] * 5, 7) * 9;
+        uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+        return result;
+    }
+    
+    // Равномерное число из [0, bound) без смещения остатка
+    uint64_t below(uint64_t bound) {
+        uint64_t threshold = (0 - bound) % bound;
+        while (true) {
+            uint64_t x = next();
+            if (x >= threshold) return x % bound;
+        }
+    }
+};
+
+uint64_t randomSeed() {
+    random_device device;
+    return ((uint64_t)device() << 32 ^ device()) ^
+           (uint64_t)chrono::steady_clock::now().time_since_epoch().count();
+}
+
+const int MAX_BOARD_SIZE = 10000;
+
+// Размер окна терминала stdout; false, если stdout - не терминал
+bool terminalSize(int& lines, int& columns) {
+#ifdef _WIN32
+    CONSOLE_SCREEN_BUFFER_INFO info;
+    if (!GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &info)) return false;
+    lines = info.srWindow.Bottom - info.srWindow.Top + 1;
+    columns = info.srWindow.Right - info.srWindow.Left + 1;
+#else
+    winsize size;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) != 0 || size.ws_row == 0 || size.ws_col == 0) return false;
+    lines = size.ws_row;
+    columns = size.ws_col;
+#endif
+    return true;
+}
+
+// Отрисовка поля в терминале. Кадр целиком собирается в одну строку и выводится одной
+// записью с одним сбросом буфера. Первый кадр рисуется полностью с очисткой экрана, затем
+// выводятся только клетки и строки подвала, изменившиеся с прошлого кадра: курсор
+// переставляется escape-последовательностью на начало каждого отрезка измененных клеток.
+// Номера строк экрана абсолютные, поэтому так дорисовывается только кадр, который целиком
+// помещается в окно терминала; больший кадр прокрутил бы экран, и он каждый раз рисуется полностью
+class FieldRenderer {
+private:
+    int rows = -1;
+    int cols = -1;
+    string title;
+    vector<char> cells;
+    vector<string> footer;
+    vector<int> footerHeights;
+    int screenLines = 0;
+    int screenColumns = 0;
+    size_t lastBytes = 0;
+    
+    int labelWidth() const {
+        return max<int>(2, to_string(rows - 1).size());
+    }
+    
+    // Сколько строк экрана занимает текст с переносами; columns == 0 - ширина неизвестна
+    static int wrappedLines(const string& text, int columns) {
+        int width = 0;
+        for (char c : text) {
+            if (((unsigned char)c & 0xC0) != 0x80) width++;
+        }
+        return columns > 0 ? max(1, (width + columns - 1) / columns) : 1;
+    }
+    
+    // Строки экрана: заголовок, пустая, номера столбцов, черта, поле, черта, пустая, подвал.
+    // Длинная строка подвала переносится и занимает несколько строк экрана
+    int boardLine(int row) const {
+        return 5 + row;
+    }
+    
+    int footerLine(size_t index) const {
+        int line = 7 + rows;
+        for (size_t k = 0; k < index; k++) line += footerHeights[k];
+        return line;
+    }
+    
+    // Заголовок и поле не переносятся, а под подвалом остается строка для ввода команды
+    // и еще одна, на которую курсор уйдет после Enter
+    bool fitsScreen() const {
+        if (screenColumns == 0) return true;
+        return wrappedLines(title, screenColumns) == 1 && labelWidth() + 2 + 3 * cols <= screenColumns &&
+               footerLine(footer.size()) < screenLines;
+    }
+    
+    static void moveTo(string& out, int line, int column) {
+        out += "\033[" + to_string(line) + ";" + to_string(column) + "H";
+    }
+    
+    static void appendCell(string& out, char cell) {
+        if (cell == '*') {
+            out += " \033[1;31m*\033[0m ";
+        } else if (cell == 'F') {
+            out += " \033[1;33mF\033[0m ";
+        } else if (cell == '#') {
+            out += " \033[1;37m#\033[0m ";
+        } else if (cell == '0') {
+            out += "   ";
+        } else if (cell >= '1' && cell <= '8') {
+            out += " \033[1;3";
+            out += cell;
+            out += "m";
+            out += cell;
+            out += "\033[0m ";
+        } else {
+            out += ' ';
+            out += cell;
+            out += ' ';
+        }
+    }
+    
+    void drawFull(string& out) const {
+        int width = labelWidth();
+        string margin(width + 1, ' ');
+        string rule;
+        for (int j = 0; j < cols; j++) rule += "───";
+        
+        out += "\033[H\033[2J" + title + "\n\n" + margin;
+        for (int j = 0; j < cols; j++) {
+            string number = to_string(j);
+            out += string(max<int>(0, 3 - number.size()), ' ') + number;
+        }
+        out += "\n" + margin + rule + "\n";
+        
+        for (int i = 0; i < rows; i++) {
+            string label = to_string(i);
+            out += string(width - label.size(), ' ') + label + "│";
+            for (int j = 0; j < cols; j++) appendCell(out, cells[(size_t)i * cols + j]);
+            out += "│\n";
+        }
+        out += margin + rule + "\n";
+        for (const string& line : footer) out += "\n" + line;
+    }
+    
+public:
+    // Следующий кадр будет нарисован полностью
+    void reset() {
+        rows = cols = -1;
+    }
+    
+    // symbols - символы cellSymbol построчно; строки подвала выводятся под полем.
+    // Курсор оставляется на строке после подвала, ниже которой экран очищается.
+    // Размер окна проверяется только для cout: в другой поток кадр пишется как есть
+    void render(const vector<char>& symbols, int r, int c, const string& heading,
+                const vector<string>& footerLines, ostream& out) {
+        string frame;
+        int lines = 0, columns = 0;
+        if (&out == &cout) terminalSize(lines, columns);
+        
+        vector<int> heights;
+        for (const string& line : footerLines) heights.push_back(wrappedLines(line, columns));
+        
+        if (r != rows || c != cols || heading != title || heights != footerHeights ||
+            lines != screenLines || columns != screenColumns || !fitsScreen()) {
+            rows = r;
+            cols = c;
+            title = heading;
+            cells = symbols;
+            footer = footerLines;
+            footerHeights = heights;
+            screenLines = lines;
+            screenColumns = columns;
+            drawFull(frame);
+        } else {
+            int column0 = labelWidth() + 2;
+            for (int i = 0; i < rows; i++) {
+                const char* before = &cells[(size_t)i * cols];
+                const char* after = &symbols[(size_t)i * cols];
+                for (int j = 0; j < cols; j++) {
+                    if (before[j] == after[j]) continue;
+                    moveTo(frame, boardLine(i), column0 + 3 * j);
+                    for (; j < cols && before[j] != after[j]; j++) appendCell(frame, after[j]);
+                }
+            }
+            cells = symbols;
+            
+            for (size_t k = 0; k < footer.size(); k++) {
+                if (footer[k] == footerLines[k]) continue;
+                moveTo(frame, footerLine(k), 1);
+                frame += footerLines[k] + "\033[K";
+                footer[k] = footerLines[k];
+            }
+        }
+        
+        moveTo(frame, footerLine(footer.size()), 1);
+        frame += "\033[J";
+        out.write(frame.data(), frame.size());
+        out.flush();
+        lastBytes = frame.size();
+    }
+    
+    size_t getLastBytes() const {
+        return lastBytes;
+    }
+};
+
+// Целые в файлах сохранений и журналов: по 7 бит в байте, старший бит - "есть продолжение"
+void writeVarint(string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out += (char)((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out += (char)value;
+}
+
+bool readVarint(const string& in, size_t& pos, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; pos < in.size() && shift < 64; shift += 7) {
+        uint8_t byte = in[pos++];
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+// Журнал ходов только для дописывания. Записи: 'G' + размеры, мины, зерно - начало партии;
+// 'O' / 'F' + строка и столбец - открытие и флаг; 'E' + итог (0 - проигрыш, 1 - победа,
+// 2 - не доиграна). Записи копятся в памяти и дописываются в файл пачками
+class MoveLog {
+private:
+    string buffer;
+    
+public:
+    void beginGame(int rows, int cols, long long mines, uint64_t seed) {
+        buffer += 'G';
+        writeVarint(buffer, rows);
+        writeVarint(buffer, cols);
+        writeVarint(buffer, mines);
+        writeVarint(buffer, seed);
+    }
+    
+    void move(char type, int row, int col) {
+        buffer += type;
+        writeVarint(buffer, row);
+        writeVarint(buffer, col);
+    }
+    
+    void endGame(int result) {
+        buffer += 'E';
+        buffer += (char)result;
+    }
+    
+    size_t size() const {
+        return buffer.size();
+    }
+    
+    // Дописывает накопленные записи в конец файла и очищает буфер
+    bool appendTo(const string& path) {
+        ofstream out(path, ios::binary | ios::app);
+        out.write(buffer.data(), buffer.size());
+        buffer.clear();
+        return (bool)out;
+    }
+};
+
+// Видимое состояние клетки для игрока: число 0-8, флаг или закрытая клетка
+const int CELL_UNKNOWN = -2;
+const int CELL_FLAG = -1;
+
+// Точные вероятности мин в закрытых клетках по видимому состоянию (флаги считаются минами).
+// Закрытые клетки рядом с цифрами (граница) делятся на компоненты, не связанные общими цифрами;
+// варианты каждой компоненты перебираются отдельно с отсечением по ограничениям цифр, а
+// результаты сводятся с учетом общего числа мин: на M мин в границе приходится
+// C(внутренние клетки, оставшиеся мины - M) расстановок во внутренних клетках.
+// Перебор компоненты запоминается по ее набору ограничений: между ходами большинство
+// компонент не меняется. Независимые компоненты перебираются параллельно
+class MineProbability {
 private:
-    static const int MAX_SIZE = 20;
+    // Число вариантов компоненты с m минами и, для каждой клетки, вариантов с миной в ней
+    struct Enumeration {
+        vector<int> cells;
+        vector<double> ways;
+        vector<vector<double>> cellWays;
+    };
+    
+    struct Constraint {
+        vector<int> cells;
+        int mines;
+    };
+    
+    int threads;
+    unordered_map<string, shared_ptr<Enumeration>> cache;
+    
+    // Многочлен по числу мин, умноженный на x^shift, прибавляется к target
+    static void addShifted(vector<double>& target, const vector<double>& source, int shift) {
+        if (target.size() < source.size() + shift) target.resize(source.size() + shift, 0.0);
+        for (size_t m = 0; m < source.size(); m++) target[m + shift] += source[m];
+    }
+    
+    // Перебор с запоминанием. Клетки идут в порядке обхода в ширину; после i клеток на
+    // дальнейший перебор влияют только остатки мин у "открытых" ограничений, в которых
+    // есть клетки и до i, и после. Варианты с одинаковыми остатками сливаются в одну
+    // вершину слоя i, и перебор превращается в проход по слоям: вперед (число путей от
+    // начала по числу мин), назад (число путей до конца) и подсчет путей через каждый
+    // выбор "мина в клетке i". Недопустимые остатки (больше оставшихся клеток или
+    // меньше нуля) отсекаются сразу
+    static void solveComponent(const vector<Constraint>& constraints, Enumeration& result) {
+        unordered_map<int, vector<int>> byCell;
+        for (int c = 0; c < (int)constraints.size(); c++) {
+            for (int cell : constraints[c].cells) byCell[cell].push_back(c);
+        }
+        
+        unordered_map<int, int> localIndex;
+        vector<char> constraintVisited(constraints.size(), 0);
+        vector<int> order(1, constraints[0].cells[0]);
+        localIndex[order[0]] = 0;
+        for (size_t head = 0; head < order.size(); head++) {
+            for (int c : byCell[order[head]]) {
+                if (constraintVisited[c]) continue;
+                constraintVisited[c] = 1;
+                for (int cell : constraints[c].cells) {
+                    if (localIndex.count(cell)) continue;
+                    localIndex[cell] = order.size();
+                    order.push_back(cell);
+                }
+            }
+        }
+        
+        int n = order.size();
+        int constraintCount = constraints.size();
+        vector<vector<int>> cellConstraints(n);
+        vector<int> first(constraintCount, n), last(constraintCount, -1);
+        for (int c = 0; c < constraintCount; c++) {
+            for (int cell : constraints[c].cells) {
+                int i = localIndex[cell];
+                cellConstraints[i].push_back(c);
+                first[c] = min(first[c], i);
+                last[c] = max(last[c], i);
+            }
+        }
+        
+        // left[i][c] - клеток ограничения c с номерами не меньше i
+        vector<vector<int>> left(n + 1, vector<int>(constraintCount, 0));
+        for (int i = n - 1; i >= 0; i--) {
+            left[i] = left[i + 1];
+            for (int c : cellConstraints[i]) left[i][c]++;
+        }
+        
+        struct Node {
+            vector<double> forward;
+            vector<double> forwardMine;
+            vector<double> backward;
+        };
+        struct Edge {
+            int from, to, mine;
+        };
+        // Как получить остаток ограничения после клетки i: из ключа вершины (source) или
+        // из исходного числа, минус мина в клетке i; limit - сколько клеток останется
+        struct Step {
+            int source;
+            int initial;
+            bool decrement;
+            int limit;
+            bool keep;
+        };
+        
+        // Ключ вершины - остатки открытых ограничений, по байту на ограничение
+        vector<vector<Node>> layers(n + 1);
+        vector<vector<Edge>> edges(n);
+        vector<string> keys(1);
+        vector<int> position(constraintCount, -1);
+        vector<char> touches(constraintCount, 0);
+        layers[0].push_back(Node());
+        layers[0][0].forward.assign(1, 1.0);
+        
+        for (int i = 0; i < n; i++) {
+            for (int c : cellConstraints[i]) touches[c] = 1;
+            
+            vector<Step> steps;
+            vector<int> nextPosition(constraintCount, -1);
+            int kept = 0;
+            for (int c = 0; c < constraintCount; c++) {
+                if (first[c] > i || last[c] < i) continue;
+                Step step = {position[c], constraints[c].mines, touches[c] != 0, left[i + 1][c], last[c] > i};
+                if (step.keep) nextPosition[c] = kept++;
+                steps.push_back(step);
+            }
+            for (int c : cellConstraints[i]) touches[c] = 0;
+            
+            vector<string> nextKeys;
+            unordered_map<string, int> nodeOf;
+            for (int from = 0; from < (int)layers[i].size(); from++) {
+                for (int mine = 0; mine <= 1; mine++) {
+                    string key(kept, 0);
+                    bool feasible = true;
+                    int k = 0;
+                    for (const Step& step : steps) {
+                        int need = (step.source >= 0 ? keys[from][step.source] : step.initial) - (step.decrement ? mine : 0);
+                        if (need < 0 || need > step.limit) {
+                            feasible = false;
+                            break;
+                        }
+                        if (step.keep) key[k++] = need;
+                    }
+                    if (!feasible) continue;
+                    
+                    auto found = nodeOf.find(key);
+                    if (found == nodeOf.end()) {
+                        found = nodeOf.emplace(key, layers[i + 1].size()).first;
+                        layers[i + 1].push_back(Node());
+                        nextKeys.push_back(key);
+                    }
+                    edges[i].push_back({from, found->second, mine});
+                    Node& to = layers[i + 1][found->second];
+                    addShifted(to.forward, layers[i][from].forward, mine);
+                    if (mine) addShifted(to.forwardMine, layers[i][from].forward, 1);
+                }
+            }
+            
+            keys.swap(nextKeys);
+            position.swap(nextPosition);
+        }
+        
+        result.cells = order;
+        result.ways.assign(n + 1, 0.0);
+        result.cellWays.assign(n, vector<double>(n + 1, 0.0));
+        if (layers[n].empty()) return;
+        
+        for (size_t m = 0; m < layers[n][0].forward.size(); m++) result.ways[m] = layers[n][0].forward[m];
+        layers[n][0].backward.assign(1, 1.0);
+        for (int i = n - 1; i >= 0; i--) {
+            for (const Edge& edge : edges[i]) {
+                const Node& to = layers[i + 1][edge.to];
+                if (!to.backward.empty()) addShifted(layers[i][edge.from].backward, to.backward, edge.mine);
+            }
+        }
+        
+        // Пути с миной в клетке i: пути в вершину слоя i + 1, пришедшие по выбору "мина"
+        // (forwardMine), умноженные на пути из нее до конца
+        for (int i = 0; i < n; i++) {
+            for (const Node& node : layers[i + 1]) {
+                const vector<double>& before = node.forwardMine;
+                const vector<double>& after = node.backward;
+                for (size_t a = 0; a < before.size(); a++) {
+                    if (before[a] == 0) continue;
+                    for (size_t b = 0; b < after.size(); b++) result.cellWays[i][a + b] += before[a] * after[b];
+                }
+            }
+        }
+    }
+    
+    static string componentKey(vector<Constraint>& constraints) {
+        for (Constraint& constraint : constraints) sort(constraint.cells.begin(), constraint.cells.end());
+        sort(constraints.begin(), constraints.end(), [](const Constraint& a, const Constraint& b) {
+            return a.cells != b.cells ? a.cells < b.cells : a.mines < b.mines;
+        });
+        
+        string key;
+        for (const Constraint& constraint : constraints) {
+            key += to_string(constraint.mines) + ':';
+            for (int cell : constraint.cells) key += to_string(cell) + ',';
+            key += ';';
+        }
+        return key;
+    }
+    
+    static vector<double> convolve(const vector<double>& a, const vector<double>& b) {
+        vector<double> result(a.size() + b.size() - 1, 0.0);
+        for (size_t i = 0; i < a.size(); i++) {
+            if (a[i] == 0) continue;
+            for (size_t j = 0; j < b.size(); j++) result[i + j] += a[i] * b[j];
+        }
+        return result;
+    }
+    
+    static double logBinomial(long long n, long long k) {
+        return lgamma(n + 1.0) - lgamma(k + 1.0) - lgamma(n - k + 1.0);
+    }
+    
+public:
+    // threads = 0 - по числу ядер
+    explicit MineProbability(int threadCount = 0)
+        : threads(threadCount > 0 ? threadCount : max(1u, thread::hardware_concurrency())) {}
+    
+    // view - по клетке на элемент (CELL_UNKNOWN, CELL_FLAG или число), mineCount - мин на поле.
+    // Возвращает вероятность мины для каждой клетки (открытые - 0, флаги - 1) и
+    // false, если видимое состояние противоречиво (например, из-за неверных флагов)
+    bool compute(const vector<int>& view, int rows, int cols, long long mineCount,
+                 vector<double>& probability, int* componentCount = nullptr) {
+        long long flags = 0;
+        vector<int> parent(rows * cols, -1);
+        auto findRoot = [&](int cell) {
+            while (parent[cell] != cell) cell = parent[cell] = parent[parent[cell]];
+            return cell;
+        };
+        
+        vector<Constraint> constraints;
+        for (int r = 0; r < rows; r++) {
+            for (int c = 0; c < cols; c++) {
+                int value = view[r * cols + c];
+                if (value == CELL_FLAG) flags++;
+                if (value <= 0) continue;
+                
+                Constraint constraint;
+                constraint.mines = value;
+                for (int nr = max(0, r - 1); nr <= min(rows - 1, r + 1); nr++) {
+                    for (int nc = max(0, c - 1); nc <= min(cols - 1, c + 1); nc++) {
+                        int neighbor = view[nr * cols + nc];
+                        if (neighbor == CELL_UNKNOWN) constraint.cells.push_back(nr * cols + nc);
+                        else if (neighbor == CELL_FLAG) constraint.mines--;
+                    }
+                }
+                if (constraint.mines < 0 || constraint.mines > (int)constraint.cells.size()) return false;
+                if (constraint.cells.empty()) continue;
+                
+                for (int cell : constraint.cells) {
+                    if (parent[cell] < 0) parent[cell] = cell;
+                }
+                for (int cell : constraint.cells) parent[findRoot(cell)] = findRoot(constraint.cells[0]);
+                constraints.push_back(constraint);
+            }
+        }
+        
+        unordered_map<int, int> componentOf;
+        vector<vector<Constraint>> groups;
+        for (Constraint& constraint : constraints) {
+            int root = findRoot(constraint.cells[0]);
+            auto found = componentOf.find(root);
+            if (found == componentOf.end()) {
+                found = componentOf.emplace(root, groups.size()).first;
+                groups.emplace_back();
+            }
+            groups[found->second].push_back(move(constraint));
+        }
+        if (componentCount) *componentCount = groups.size();
+        
+        vector<string> keys(groups.size());
+        vector<shared_ptr<Enumeration>> parts(groups.size());
+        vector<size_t> pending;
+        for (size_t g = 0; g < groups.size(); g++) {
+            keys[g] = componentKey(groups[g]);
+            auto cached = cache.find(keys[g]);
+            if (cached != cache.end()) {
+                parts[g] = cached->second;
+            } else {
+                parts[g] = make_shared<Enumeration>();
+                pending.push_back(g);
+            }
+        }
+        
+        int workerCount = min<int>(threads, pending.size());
+        if (workerCount <= 1) {
+            for (size_t g : pending) solveComponent(groups[g], *parts[g]);
+        } else {
+            atomic<size_t> nextTask(0);
+            vector<thread> workers;
+            for (int t = 0; t < workerCount; t++) {
+                workers.emplace_back([&] {
+                    for (size_t task = nextTask++; task < pending.size(); task = nextTask++) {
+                        solveComponent(groups[pending[task]], *parts[pending[task]]);
+                    }
+                });
+            }
+            for (thread& worker : workers) worker.join();
+        }
+        for (size_t g : pending) cache[keys[g]] = parts[g];
+        
+        // Нормировка каждой компоненты на максимум сокращается в отношениях и защищает от переполнения
+        vector<vector<double>> ways(parts.size());
+        vector<double> scale(parts.size(), 1.0);
+        for (size_t g = 0; g < parts.size(); g++) {
+            scale[g] = *max_element(parts[g]->ways.begin(), parts[g]->ways.end());
+            if (scale[g] == 0) return false;
+            for (double count : parts[g]->ways) ways[g].push_back(count / scale[g]);
+        }
+        
+        vector<vector<double>> prefix(parts.size() + 1), suffix(parts.size() + 1);
+        prefix[0] = suffix[parts.size()] = vector<double>(1, 1.0);
+        for (size_t g = 0; g < parts.size(); g++) prefix[g + 1] = convolve(prefix[g], ways[g]);
+        for (size_t g = parts.size(); g-- > 0;) suffix[g] = convolve(ways[g], suffix[g + 1]);
+        const vector<double>& total = prefix[parts.size()];
+        
+        long long frontier = 0;
+        for (const auto& part : parts) frontier += part->cells.size();
+        long long interior = (long long)rows * cols - frontier - flags;
+        for (int value : view) {
+            if (value >= 0) interior--;
+        }
+        long long minesLeft = mineCount - flags;
+        
+        // weight[M] ~ C(interior, minesLeft - M), в логарифмах со сдвигом на максимум
+        vector<double> weight(total.size(), 0.0);
+        double maxLog = -INFINITY;
+        for (long long m = 0; m < (long long)total.size(); m++) {
+            long long rest = minesLeft - m;
+            if (rest >= 0 && rest <= interior) maxLog = max(maxLog, logBinomial(interior, rest));
+        }
+        if (maxLog == -INFINITY) return false;
+        for (long long m = 0; m < (long long)total.size(); m++) {
+            long long rest = minesLeft - m;
+            if (rest >= 0 && rest <= interior) weight[m] = exp(logBinomial(interior, rest) - maxLog);
+        }
+        
+        double norm = 0, interiorMines = 0;
+        for (size_t m = 0; m < total.size(); m++) {
+            norm += total[m] * weight[m];
+            interiorMines += total[m] * weight[m] * (minesLeft - (long long)m);
+        }
+        if (norm == 0) return false;
+        
+        probability.assign(rows * cols, 0.0);
+        double interiorProbability = interior > 0 ? interiorMines / norm / interior : 0.0;
+        for (int cell = 0; cell < rows * cols; cell++) {
+            if (view[cell] == CELL_FLAG) probability[cell] = 1.0;
+            else if (view[cell] == CELL_UNKNOWN) probability[cell] = interiorProbability;
+        }
+        
+        for (size_t g = 0; g < parts.size(); g++) {
+            vector<double> others = convolve(prefix[g], suffix[g + 1]);
+            const Enumeration& part = *parts[g];
+            vector<double> tail(part.ways.size(), 0.0);
+            for (size_t m = 0; m < part.ways.size(); m++) {
+                for (size_t k = 0; k < others.size(); k++) tail[m] += others[k] * weight[m + k];
+            }
+            for (size_t i = 0; i < part.cells.size(); i++) {
+                double sum = 0;
+                for (size_t m = 0; m < part.ways.size(); m++) sum += part.cellWays[i][m] / scale[g] * tail[m];
+                probability[part.cells[i]] = sum / norm;
+            }
+        }
+        return true;
+    }
     
+    void clearCache() {
+        cache.clear();
+    }
+};
+
+class Minesweeper {
+private:
     int rows;
     int cols;
-    int mineCount;
+    long long mineCount;
     
-    char field[MAX_SIZE][MAX_SIZE];
-    char display[MAX_SIZE][MAX_SIZE];
-    bool revealed[MAX_SIZE][MAX_SIZE];
-    bool flagged[MAX_SIZE][MAX_SIZE];
+    BitBoard mines;
+    BitBoard revealed;
+    BitBoard flagged;
+    BitBoard neighborPlanes[4];
+    BitBoard emptyCells;
     
-    int revealedCount;
+    long long revealedCount;
     bool gameOver;
     bool won;
     
+    uint64_t seed;
+    bool minesPlaced;
+    bool seeded;
+    int firstRow;
+    int firstCol;
+    FieldRenderer renderer;
+    MoveLog* moveLog;
+    MineProbability probabilities;
+    
+    // Открывает клетки add строки row (кроме флагов и уже открытых) и возвращает новые пустые
+    uint64_t openWord(int row, int w, uint64_t add) {
+        add &= ~revealed.row(row)[w] & ~flagged.row(row)[w] & revealed.columnMask(w);
+        revealed.row(row)[w] |= add;
+        revealedCount += bitset<64>(add).count();
+        return add & emptyCells.row(row)[w];
+    }
+    
 public:
-    Minesweeper(int r = 10, int c = 10, int mines = 10) 
-        : rows(r), cols(c), mineCount(mines), revealedCount(0), 
-          gameOver(false), won(false) {
+    // Мины расставляются при первом открытии клетки, так что первый ход безопасен.
+    // Одно и то же зерно и первый ход дают одно и то же поле
+    Minesweeper(int r = 10, int c = 10, long long mines = 10, uint64_t fieldSeed = randomSeed())
+        : rows(max(1, r)), cols(max(1, c)), mineCount(mines), revealedCount(0),
+          gameOver(false), won(false), seed(fieldSeed), minesPlaced(false), seeded(true),
+          firstRow(-1), firstCol(-1), moveLog(nullptr) {
         
-        if (rows > MAX_SIZE) rows = MAX_SIZE;
-        if (cols > MAX_SIZE) cols = MAX_SIZE;
-        if (mineCount > rows * cols - 1) mineCount = rows * cols - 1;
+        if (mineCount > (long long)rows * cols - 1) mineCount = (long long)rows * cols - 1;
+        if (mineCount < 0) mineCount = 0;
         
         initializeField();
     }
     
+    // Поле с заранее расставленными минами (для воспроизведения партий)
+    Minesweeper(int r, int c, const BitBoard& minefield)
+        : rows(r), cols(c), mineCount(minefield.count()), mines(minefield), revealed(r, c), flagged(r, c),
+          revealedCount(0), gameOver(false), won(false), seed(0), minesPlaced(true), seeded(false),
+          firstRow(-1), firstCol(-1), moveLog(nullptr) {
+        calculateNumbers();
+    }
+    
     // Инициализация игрового поля
     void initializeField() {
-        for (int i = 0; i < rows; i++) {
-            for (int j = 0; j < cols; j++) {
-                field[i][j] = '0';
-                display[i][j] = '#';
-                revealed[i][j] = false;
-                flagged[i][j] = false;
+        mines = BitBoard(rows, cols);
+        revealed = BitBoard(rows, cols);
+        flagged = BitBoard(rows, cols);
+        for (BitBoard& plane : neighborPlanes) {
+            plane = BitBoard(rows, cols);
+        }
+        emptyCells = BitBoard(rows, cols);
+        minesPlaced = false;
+    }
+    
+    // Случайное подмножество разрешенных клеток по алгоритму Флойда - частичному перемешиванию
+    // Фишера-Йетса без массива перестановки: множество уже выбранных клеток - сама битовая доска,
+    // так что работа - O(числа выбираемых клеток) при любом размере поля. При плотности больше
+    // половины выбираются свободные клетки, а мины ставятся на все остальные.
+    // Клетка (safeRow, safeCol) и, если хватает места, ее соседи исключаются; safeRow = -1 - без исключений
+    void placeMines(int safeRow = -1, int safeCol = -1) {
+        long long cells = (long long)rows * cols;
+        vector<long long> excluded;
+        if (isValid(safeRow, safeCol)) {
+            int radius = cells - 9 >= mineCount ? 1 : 0;
+            for (int r = max(0, safeRow - radius); r <= min(rows - 1, safeRow + radius); r++) {
+                for (int c = max(0, safeCol - radius); c <= min(cols - 1, safeCol + radius); c++) {
+                    excluded.push_back((long long)r * cols + c);
+                }
             }
         }
         
-        placeMines();
+        // Номер среди разрешенных клеток -> номер клетки поля (excluded отсортирован)
+        auto toCell = [&](long long index) {
+            for (long long skip : excluded) {
+                if (skip <= index) index++;
+            }
+            return index;
+        };
+        
+        Xoshiro256 rng(seed);
+        long long available = cells - excluded.size();
+        bool complement = mineCount > available / 2;
+        long long chosen = complement ? available - mineCount : mineCount;
+        
+        mines.clear();
+        for (long long j = available - chosen; j < available; j++) {
+            long long cell = toCell(rng.below(j + 1));
+            if (mines.test(cell / cols, cell % cols)) cell = toCell(j);
+            mines.set(cell / cols, cell % cols);
+        }
+        
+        if (complement) {
+            for (int r = 0; r < rows; r++) {
+                for (int w = 0; w < mines.rowWords(); w++) {
+                    mines.row(r)[w] = ~mines.row(r)[w] & mines.columnMask(w);
+                }
+            }
+            for (long long cell : excluded) mines.reset(cell / cols, cell % cols);
+        }
+        
+        minesPlaced = true;
+        firstRow = safeRow;
+        firstCol = safeCol;
         calculateNumbers();
     }
     
-    void placeMines() {
-        srand(time(0));
-        int placedMines = 0;
+    uint64_t getSeed() const {
+        return seed;
+    }
+    
+    // Все ходы партии (начиная с этого момента) записываются в log
+    void setMoveLog(MoveLog* log) {
+        moveLog = log;
+        if (moveLog) moveLog->beginGame(rows, cols, mineCount, seed);
+    }
+    
+    // Сохранение: "MSWP", версия, размеры, мины, зерно и первый ход (по ним поле
+    // восстанавливается заново), затем упакованные открытые клетки и флаги.
+    // Мины записываются, только если поле не из зерна
+    bool saveSnapshot(ostream& out) const {
+        string data = "MSWP";
+        data += (char)1;
+        writeVarint(data, rows);
+        writeVarint(data, cols);
+        writeVarint(data, mineCount);
+        writeVarint(data, seed);
+        data += (char)(seeded | minesPlaced << 1);
+        writeVarint(data, firstRow + 1);
+        writeVarint(data, firstCol + 1);
+        if (minesPlaced && !seeded) mines.pack(data);
+        revealed.pack(data);
+        flagged.pack(data);
         
-        while (placedMines < mineCount) {
-            int r = rand() % rows;
-            int c = rand() % cols;
-            
-            if (field[r][c] != '*') {
-                field[r][c] = '*';
-                placedMines++;
+        out.write(data.data(), data.size());
+        return (bool)out;
+    }
+    
+    bool loadSnapshot(istream& in) {
+        string data((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+        size_t pos = 5;
+        if (data.compare(0, 4, "MSWP") != 0 || data.size() < 5 || data[4] != 1) return false;
+        
+        uint64_t fields[4];
+        for (uint64_t& field : fields) {
+            if (!readVarint(data, pos, field)) return false;
+        }
+        if (fields[0] < 1 || fields[0] > MAX_BOARD_SIZE || fields[1] < 1 || fields[1] > MAX_BOARD_SIZE ||
+            fields[2] >= fields[0] * fields[1] || pos >= data.size()) {
+            return false;
+        }
+        int state = data[pos++];
+        uint64_t savedRow, savedCol;
+        if (!readVarint(data, pos, savedRow) || !readVarint(data, pos, savedCol)) return false;
+        
+        rows = fields[0];
+        cols = fields[1];
+        mineCount = fields[2];
+        seed = fields[3];
+        seeded = state & 1;
+        initializeField();
+        probabilities.clearCache();
+        revealedCount = 0;
+        gameOver = won = false;
+        
+        if (state & 2) {
+            if (seeded) {
+                placeMines((int)savedRow - 1, (int)savedCol - 1);
+            } else {
+                if (!mines.unpack(data, pos)) return false;
+                minesPlaced = true;
+                calculateNumbers();
             }
         }
+        if (!revealed.unpack(data, pos) || !flagged.unpack(data, pos)) return false;
+        
+        bool exploded = false;
+        for (int r = 0; r < rows; r++) {
+            for (int w = 0; w < revealed.rowWords(); w++) {
+                revealedCount += bitset<64>(revealed.row(r)[w] & ~mines.row(r)[w]).count();
+                if (revealed.row(r)[w] & mines.row(r)[w]) exploded = true;
+            }
+        }
+        if (exploded) {
+            gameOver = true;
+        } else {
+            checkWin();
+        }
+        renderer.reset();
+        return true;
     }
     
     void calculateNumbers() {
-        for (int i = 0; i < rows; i++) {
-            for (int j = 0; j < cols; j++) {
-                if (field[i][j] != '*') {
-                    int count = countAdjacentMines(i, j);
-                    field[i][j] = '0' + count;
-                }
+        for (BitBoard& plane : neighborPlanes) {
+            plane = BitBoard(rows, cols);
+        }
+        countNeighbors(mines, rows, neighborPlanes);
+        
+        emptyCells = BitBoard(rows, cols);
+        for (int r = 0; r < rows; r++) {
+            for (int w = 0; w < mines.rowWords(); w++) {
+                uint64_t nonZero = neighborPlanes[0].row(r)[w] | neighborPlanes[1].row(r)[w] |
+                                   neighborPlanes[2].row(r)[w] | neighborPlanes[3].row(r)[w];
+                emptyCells.row(r)[w] = ~(nonZero | mines.row(r)[w]) & mines.columnMask(w);
             }
         }
     }
     
     int countAdjacentMines(int row, int col) {
-        int count = 0;
-        
-        for (int dr = -1; dr <= 1; dr++) {
-            for (int dc = -1; dc <= 1; dc++) {
-                if (dr == 0 && dc == 0) continue;
-                
-                int newRow = row + dr;
-                int newCol = col + dc;
-                
-                if (isValid(newRow, newCol) && field[newRow][newCol] == '*') {
-                    count++;
-                }
-            }
-        }
-        
-        return count;
+        return neighborPlanes[0].test(row, col) | neighborPlanes[1].test(row, col) << 1 |
+               neighborPlanes[2].test(row, col) << 2 | neighborPlanes[3].test(row, col) << 3;
     }
     
     bool isValid(int row, int col) {
         return row >= 0 && row < rows && col >= 0 && col < cols;
     }
     
+    // Символ клетки: '*' - мина, '0'-'8' - число, 'F' - флаг, '#' - закрытая
+    char cellSymbol(int row, int col, bool showMines) {
+        if (showMines || revealed.test(row, col)) {
+            return mines.test(row, col) ? '*' : '0' + countAdjacentMines(row, col);
+        }
+        if (gameOver && !won && mines.test(row, col)) return '*';
+        return flagged.test(row, col) ? 'F' : '#';
+    }
+    
+    // Раскрытие пустой области построчно, по 64 клетки за операцию. Для строки из очереди
+    // новые пустые клетки (seeds) достраиваются до целых отрезков пустых клеток, после чего
+    // отрезки с ободком в одну клетку открываются в самой строке и в соседних; новые пустые
+    // клетки соседних строк становятся их seeds. Рекурсии нет, победа проверяется один раз
     void revealCell(int row, int col) {
-        if (!isValid(row, col) || revealed[row][col] || flagged[row][col]) {
+        if (!isValid(row, col) || revealed.test(row, col) || flagged.test(row, col)) {
             return;
         }
         
-        revealed[row][col] = true;
-        revealedCount++;
-        display[row][col] = field[row][col];
+        if (moveLog) moveLog->move('O', row, col);
+        if (!minesPlaced) {
+            placeMines(row, col);
+        }
         
-        if (field[row][col] == '*') {
+        if (mines.test(row, col)) {
+            revealed.set(row, col);
             gameOver = true;
             won = false;
-            revealAllMines();
             return;
         }
         
-        if (field[row][col] == '0') {
-            for (int dr = -1; dr <= 1; dr++) {
-                for (int dc = -1; dc <= 1; dc++) {
-                    if (dr == 0 && dc == 0) continue;
-                    revealCell(row + dr, col + dc);
+        revealed.set(row, col);
+        revealedCount++;
+        
+        if (emptyCells.test(row, col)) {
+            int words = revealed.rowWords();
+            BitBoard seeds(rows, cols);
+            seeds.set(row, col);
+            vector<char> queued(rows, 0);
+            vector<int> queue(1, row);
+            queued[row] = 1;
+            
+            vector<uint64_t> mask(words), runs(words), halo(words), scratch;
+            
+            while (!queue.empty()) {
+                int r = queue.back();
+                queue.pop_back();
+                queued[r] = 0;
+                
+                uint64_t* rowSeeds = seeds.row(r);
+                const uint64_t* empty = emptyCells.row(r);
+                const uint64_t* flags = flagged.row(r);
+                for (int w = 0; w < words; w++) mask[w] = empty[w] & ~flags[w];
+                fillRuns(mask.data(), rowSeeds, runs.data(), words, scratch);
+                fill(rowSeeds, rowSeeds + words, 0);
+                
+                for (int w = 0; w < words; w++) {
+                    halo[w] = runs[w] | runs[w] << 1 | runs[w] >> 1 |
+                              (w > 0 ? runs[w - 1] >> 63 : 0) | (w + 1 < words ? runs[w + 1] << 63 : 0);
+                }
+                
+                for (int nr = max(0, r - 1); nr <= min(rows - 1, r + 1); nr++) {
+                    bool grown = false;
+                    uint64_t* next = seeds.row(nr);
+                    
+                    for (int w = 0; w < words; w++) {
+                        uint64_t fresh = openWord(nr, w, halo[w]);
+                        if (nr != r && fresh != 0) {
+                            next[w] |= fresh;
+                            grown = true;
+                        }
+                    }
+                    
+                    if (grown && !queued[nr]) {
+                        queued[nr] = 1;
+                        queue.push_back(nr);
+                    }
                 }
             }
         }
@@ -126,160 +1164,734 @@ public:
         checkWin();
     }
     
+    long long getRevealedCount() const {
+        return revealedCount;
+    }
+    
+    int getRows() const { return rows; }
+    int getCols() const { return cols; }
+    long long getMineCount() const { return mineCount; }
+    const BitBoard& getRevealed() const { return revealed; }
+    bool isGameOver() const { return gameOver; }
+    bool isWon() const { return won; }
+    
+    // Поле глазами игрока: CELL_UNKNOWN, CELL_FLAG или число у открытой клетки
+    vector<int> playerView() {
+        vector<int> view(rows * cols);
+        for (int r = 0; r < rows; r++) {
+            for (int c = 0; c < cols; c++) {
+                char symbol = cellSymbol(r, c, false);
+                view[r * cols + c] = symbol == '#' ? CELL_UNKNOWN : symbol == 'F' ? CELL_FLAG : symbol - '0';
+            }
+        }
+        return view;
+    }
+    
+    // Подсказка: закрытая клетка с наименьшей точной вероятностью мины. Движок живет вместе
+    // с партией, так что компоненты границы, не изменившиеся с прошлой подсказки, берутся из кэша
+    string hint() {
+        vector<double> probability;
+        if (!probabilities.compute(playerView(), rows, cols, mineCount, probability)) {
+            return "Флаги противоречат открытым числам - подсказка недоступна.";
+        }
+        
+        int best = -1;
+        for (int cell = 0; cell < rows * cols; cell++) {
+            if (revealed.test(cell / cols, cell % cols) || flagged.test(cell / cols, cell % cols)) continue;
+            if (best < 0 || probability[cell] < probability[best]) best = cell;
+        }
+        if (best < 0) return "";
+        
+        ostringstream text;
+        text << "Подсказка: клетка (" << best / cols << ", " << best % cols << "), вероятность мины "
+             << fixed << setprecision(1) << probability[best] * 100 << "%";
+        return text.str();
+    }
+    
     void toggleFlag(int row, int col) {
-        if (!isValid(row, col) || revealed[row][col]) {
+        if (!isValid(row, col) || revealed.test(row, col)) {
             return;
         }
         
-        flagged[row][col] = !flagged[row][col];
-        display[row][col] = flagged[row][col] ? 'F' : '#';
+        if (moveLog) moveLog->move('F', row, col);
+        flagged.flip(row, col);
+    }
+    
+    void checkWin() {
+        long long totalCells = (long long)rows * cols;
+        if (!gameOver && revealedCount == totalCells - mineCount) {
+            gameOver = true;
+            won = true;
+        }
     }
     
-    void revealAllMines() {
+    // Кадр поля через FieldRenderer: после первого кадра выводятся только изменения.
+    // message - строка сообщения под полем (до следующего кадра)
+    void displayField(bool showMines = false, const string& message = "", ostream& out = cout) {
+        vector<char> symbols((size_t)rows * cols);
         for (int i = 0; i < rows; i++) {
             for (int j = 0; j < cols; j++) {
-                if (field[i][j] == '*') {
-                    display[i][j] = '*';
+                symbols[(size_t)i * cols + j] = cellSymbol(i, j, showMines);
+            }
+        }
+        
+        string title = "ИГРА 'САПЁР': поле " + to_string(rows) + "x" + to_string(cols) +
+                       ", мин " + to_string(mineCount) + ", зерно " + to_string(seed);
+        renderer.render(symbols, rows, cols, title,
+                        {"Мин осталось: " + to_string(mineCount - countFlags()), message,
+                         "Команды: O <строка> <столбец> - открыть, F <строка> <столбец> - флаг, H - подсказка, "
+                         "S <файл> - сохранить, Q - выход"},
+                        out);
+    }
+    
+    size_t lastFrameBytes() const {
+        return renderer.getLastBytes();
+    }
+    
+    void resetDisplay() {
+        renderer.reset();
+    }
+    
+    // Подсчет установленных флагов
+    int countFlags() {
+        return flagged.count();
+    }
+    
+    void play() {
+        string message;
+        resetDisplay();
+        
+        while (!gameOver) {
+            displayField(false, message);
+            message.clear();
+            
+            char command;
+            int row, col;
+            
+            cout << "Введите команду: ";
+            cin >> command;
+            
+            command = toupper(command);
+            
+            if (command == 'Q') {
+                cout << "Игра прервана." << endl;
+                break;
+            }
+            
+            if (command == 'H') {
+                message = hint();
+                continue;
+            }
+            
+            if (command == 'S') {
+                string path;
+                cin >> path;
+                ofstream file(path, ios::binary);
+                message = file && saveSnapshot(file) ? "Партия сохранена в " + path : "Не удалось сохранить " + path;
+                continue;
+            }
+            
+            if (command == 'O' || command == 'F') {
+                cin >> row >> col;
+                
+                if (!isValid(row, col)) {
+                    message = "Неверные координаты! Попробуйте снова.";
+                    continue;
+                }
+                
+                if (command == 'O') {
+                    revealCell(row, col);
+                } else if (command == 'F') {
+                    toggleFlag(row, col);
+                }
+            } else {
+                message = "Неверная команда! Используйте O, F, H, S или Q.";
+            }
+        }
+        
+        if (gameOver) {
+            displayField(true);
+            
+            if (won) {
+                cout << "\n╔════════════════════════════════════════╗" << endl;
+                cout << "║          🎉 ПОЗДРАВЛЯЕМ! 🎉           ║" << endl;
+                cout << "║         ВЫ ВЫИГРАЛИ!                 ║" << endl;
+                cout << "╚════════════════════════════════════════╝" << endl;
+            } else {
+                cout << "\n╔════════════════════════════════════════╗" << endl;
+                cout << "║           💥 БУМ! 💥                  ║" << endl;
+                cout << "║         ВЫ ПРОИГРАЛИ!                ║" << endl;
+                cout << "╚════════════════════════════════════════╝" << endl;
+            }
+        }
+    }
+    
+    void debugMode() {
+        cout << "\n=== РЕЖИМ ОТЛАДКИ (все мины видны) ===" << endl;
+        displayField(true);
+    }
+};
+
+// Неограниченное поле из фрагментов 64x64. Фрагмент адресуется парой номеров в хеш-таблице
+// и создается при первом обращении: его мины однозначно получаются из зерна поля и
+// номеров фрагмента, поэтому фрагмент без открытых клеток и флагов можно просто выбросить.
+// Строка фрагмента - ровно одно 64-битное слово. Фрагменты дальше keepRadius от игрока
+// вытесняются: от них остаются только открытые клетки и флаги (1 КБ), так что память
+// растет с исследованной площадью, а не с размером поля
+class InfiniteField {
+private:
+    static const int CHUNK = 64;
+    
+    struct Chunk {
+        uint64_t mines[CHUNK] = {};
+        uint64_t revealed[CHUNK] = {};
+        uint64_t flagged[CHUNK] = {};
+        uint64_t empty[CHUNK] = {};
+        uint64_t planes[4][CHUNK] = {};
+        uint64_t seeds[CHUNK] = {};
+        uint64_t pendingRows = 0;
+        bool numbered = false;
+        bool queued = false;
+    };
+    
+    struct KeyHash {
+        size_t operator()(uint64_t key) const {
+            key = (key ^ key >> 30) * 0xBF58476D1CE4E5B9ULL;
+            key = (key ^ key >> 27) * 0x94D049BB133111EBULL;
+            return key ^ key >> 31;
+        }
+    };
+    
+    uint64_t seed;
+    int minesPerChunk;
+    int keepRadius;
+    unordered_map<uint64_t, unique_ptr<Chunk>, KeyHash> chunks;
+    unordered_map<uint64_t, vector<uint64_t>, KeyHash> stored;
+    vector<uint64_t> queue;
+    vector<uint64_t> scratch;
+    long long revealedCount = 0;
+    long long explosions = 0;
+    long long generated = 0;
+    long long playerRow = 0;
+    long long playerCol = 0;
+    FieldRenderer renderer;
+    
+    static uint64_t key(long long chunkRow, long long chunkCol) {
+        return (uint64_t)(uint32_t)chunkRow << 32 | (uint32_t)chunkCol;
+    }
+    
+    static long long chunkOf(long long coordinate) {
+        return coordinate >> 6;
+    }
+    
+    // Фрагмент с минами (и сохраненными открытыми клетками, если он уже вытеснялся)
+    Chunk& chunkAt(long long chunkRow, long long chunkCol) {
+        unique_ptr<Chunk>& slot = chunks[key(chunkRow, chunkCol)];
+        if (slot) return *slot;
+        
+        slot.reset(new Chunk());
+        generated++;
+        
+        // Выборка Флойда по 4096 клеткам фрагмента, как в Minesweeper::placeMines
+        Xoshiro256 rng(seed ^ KeyHash()(key(chunkRow, chunkCol)));
+        for (int j = CHUNK * CHUNK - minesPerChunk; j < CHUNK * CHUNK; j++) {
+            int cell = rng.below(j + 1);
+            if (slot->mines[cell >> 6] >> (cell & 63) & 1) cell = j;
+            slot->mines[cell >> 6] |= (uint64_t)1 << (cell & 63);
+        }
+        
+        auto saved = stored.find(key(chunkRow, chunkCol));
+        if (saved != stored.end()) {
+            copy(saved->second.begin(), saved->second.begin() + CHUNK, slot->revealed);
+            copy(saved->second.begin() + CHUNK, saved->second.end(), slot->flagged);
+            stored.erase(saved);
+        }
+        return *slot;
+    }
+    
+    // Фрагмент с посчитанными числами: мины соседних фрагментов дают рамку в одну клетку,
+    // и поле 66x66 считается тем же побитовым сумматором countNeighbors
+    Chunk& numberedAt(long long chunkRow, long long chunkCol) {
+        Chunk& chunk = chunkAt(chunkRow, chunkCol);
+        if (chunk.numbered) return chunk;
+        
+        BitBoard frame(CHUNK + 2, CHUNK + 2);
+        for (int dr = -1; dr <= 1; dr++) {
+            for (int dc = -1; dc <= 1; dc++) {
+                const Chunk& source = dr == 0 && dc == 0 ? chunk : chunkAt(chunkRow + dr, chunkCol + dc);
+                for (int r = 0; r < CHUNK; r++) {
+                    int frameRow = r + 1 + dr * CHUNK;
+                    if (frameRow < 0 || frameRow >= CHUNK + 2) continue;
+                    uint64_t bits = source.mines[r];
+                    if (dc == 0) {
+                        frame.row(frameRow)[0] |= bits << 1;
+                        frame.row(frameRow)[1] |= bits >> 63;
+                    } else if (dc < 0 && bits >> 63) {
+                        frame.set(frameRow, 0);
+                    } else if (dc > 0 && bits & 1) {
+                        frame.set(frameRow, CHUNK + 1);
+                    }
                 }
             }
         }
+        
+        BitBoard planes[4] = {BitBoard(CHUNK + 2, CHUNK + 2), BitBoard(CHUNK + 2, CHUNK + 2),
+                              BitBoard(CHUNK + 2, CHUNK + 2), BitBoard(CHUNK + 2, CHUNK + 2)};
+        countNeighbors(frame, CHUNK + 2, planes);
+        for (int r = 0; r < CHUNK; r++) {
+            uint64_t nonZero = 0;
+            for (int p = 0; p < 4; p++) {
+                const uint64_t* line = planes[p].row(r + 1);
+                chunk.planes[p][r] = line[0] >> 1 | line[1] << 63;
+                nonZero |= chunk.planes[p][r];
+            }
+            chunk.empty[r] = ~(nonZero | chunk.mines[r]);
+        }
+        chunk.numbered = true;
+        return chunk;
     }
     
-    void checkWin() {
-        int totalCells = rows * cols;
-        if (revealedCount == totalCells - mineCount) {
-            gameOver = true;
-            won = true;
+    // Открывает клетки bits строки row фрагмента (row может выйти на соседний по вертикали);
+    // новые пустые клетки становятся затравкой фрагмента, а чужой фрагмент встает в очередь
+    void openBits(long long chunkRow, long long chunkCol, int row, uint64_t bits, const Chunk* current) {
+        if (row < 0) {
+            chunkRow--;
+            row += CHUNK;
+        } else if (row >= CHUNK) {
+            chunkRow++;
+            row -= CHUNK;
+        }
+        
+        Chunk& chunk = numberedAt(chunkRow, chunkCol);
+        uint64_t add = bits & ~chunk.revealed[row] & ~chunk.flagged[row];
+        if (add == 0) return;
+        chunk.revealed[row] |= add;
+        revealedCount += bitset<64>(add).count();
+        
+        uint64_t fresh = add & chunk.empty[row];
+        if (fresh == 0) return;
+        chunk.seeds[row] |= fresh;
+        chunk.pendingRows |= (uint64_t)1 << row;
+        if (&chunk != current && !chunk.queued) {
+            chunk.queued = true;
+            queue.push_back(key(chunkRow, chunkCol));
+        }
+    }
+    
+    // Раскрытие внутри фрагмента - как Minesweeper::revealCell, но строка - одно слово;
+    // отрезки, касающиеся краев, продолжаются в соседних фрагментах через openBits
+    void drainQueue() {
+        while (!queue.empty()) {
+            uint64_t id = queue.back();
+            queue.pop_back();
+            long long chunkRow = (int32_t)(id >> 32), chunkCol = (int32_t)id;
+            Chunk& chunk = *chunks[id];
+            chunk.queued = false;
+            
+            while (chunk.pendingRows != 0) {
+                int r = __builtin_ctzll(chunk.pendingRows);
+                chunk.pendingRows &= chunk.pendingRows - 1;
+                uint64_t seeds = chunk.seeds[r];
+                uint64_t mask = chunk.empty[r] & ~chunk.flagged[r];
+                uint64_t runs;
+                chunk.seeds[r] = 0;
+                fillRuns(&mask, &seeds, &runs, 1, scratch);
+                
+                uint64_t halo = runs | runs << 1 | runs >> 1;
+                for (int nr = r - 1; nr <= r + 1; nr++) {
+                    openBits(chunkRow, chunkCol, nr, halo, &chunk);
+                    if (runs & 1) openBits(chunkRow, chunkCol - 1, nr, (uint64_t)1 << 63, &chunk);
+                    if (runs >> 63) openBits(chunkRow, chunkCol + 1, nr, 1, &chunk);
+                }
+            }
+        }
+    }
+    
+    // Вытеснение далеких фрагментов; открытые клетки и флаги сохраняются отдельно
+    void evictFar() {
+        long long centerRow = chunkOf(playerRow), centerCol = chunkOf(playerCol);
+        for (auto it = chunks.begin(); it != chunks.end();) {
+            long long chunkRow = (int32_t)(it->first >> 32), chunkCol = (int32_t)it->first;
+            if (max(llabs(chunkRow - centerRow), llabs(chunkCol - centerCol)) <= keepRadius) {
+                ++it;
+                continue;
+            }
+            
+            const Chunk& chunk = *it->second;
+            uint64_t touched = 0;
+            for (int r = 0; r < CHUNK; r++) touched |= chunk.revealed[r] | chunk.flagged[r];
+            if (touched != 0) {
+                vector<uint64_t>& saved = stored[it->first];
+                saved.assign(chunk.revealed, chunk.revealed + CHUNK);
+                saved.insert(saved.end(), chunk.flagged, chunk.flagged + CHUNK);
+            }
+            it = chunks.erase(it);
+        }
+    }
+    
+public:
+    // density - доля мин, keepRadius - сколько фрагментов вокруг игрока держать в памяти
+    InfiniteField(uint64_t fieldSeed, double density, int radius = 4)
+        : seed(fieldSeed), minesPerChunk((int)(min(max(density, 0.0), 1.0) * CHUNK * CHUNK)), keepRadius(radius) {}
+    
+    // Символ клетки, как у Minesweeper::cellSymbol
+    char cellSymbol(long long row, long long col, bool showMines = false) {
+        Chunk& chunk = numberedAt(chunkOf(row), chunkOf(col));
+        int r = row & 63, c = col & 63;
+        bool mine = chunk.mines[r] >> c & 1;
+        if (showMines || chunk.revealed[r] >> c & 1) {
+            if (mine) return '*';
+            int count = 0;
+            for (int p = 0; p < 4; p++) count |= (chunk.planes[p][r] >> c & 1) << p;
+            return '0' + count;
+        }
+        return chunk.flagged[r] >> c & 1 ? 'F' : '#';
+    }
+    
+    // Открывает клетку; false - если в ней мина
+    bool revealCell(long long row, long long col) {
+        playerRow = row;
+        playerCol = col;
+        long long chunkRow = chunkOf(row), chunkCol = chunkOf(col);
+        int r = row & 63, c = col & 63;
+        Chunk& chunk = numberedAt(chunkRow, chunkCol);
+        uint64_t bit = (uint64_t)1 << c;
+        
+        bool safe = true;
+        if (!((chunk.revealed[r] | chunk.flagged[r]) & bit)) {
+            if (chunk.mines[r] & bit) {
+                chunk.revealed[r] |= bit;
+                explosions++;
+                safe = false;
+            } else {
+                chunk.queued = true;
+                queue.push_back(key(chunkRow, chunkCol));
+                openBits(chunkRow, chunkCol, r, bit, nullptr);
+                drainQueue();
+            }
+        }
+        
+        evictFar();
+        return safe;
+    }
+    
+    void toggleFlag(long long row, long long col) {
+        Chunk& chunk = chunkAt(chunkOf(row), chunkOf(col));
+        int r = row & 63, c = col & 63;
+        if (!(chunk.revealed[r] >> c & 1)) chunk.flagged[r] ^= (uint64_t)1 << c;
+    }
+    
+    long long getRevealedCount() const { return revealedCount; }
+    long long getExplosions() const { return explosions; }
+    long long getGeneratedChunks() const { return generated; }
+    size_t getLoadedChunks() const { return chunks.size(); }
+    size_t getStoredChunks() const { return stored.size(); }
+    
+    // Ближайшая к (row, col) пустая клетка того же фрагмента - стартовая точка игры
+    bool findStart(long long& row, long long& col) {
+        const Chunk& chunk = numberedAt(chunkOf(row), chunkOf(col));
+        long long baseRow = row & ~63LL, baseCol = col & ~63LL;
+        long long best = -1;
+        for (int r = 0; r < CHUNK; r++) {
+            for (uint64_t bits = chunk.empty[r]; bits != 0; bits &= bits - 1) {
+                int c = __builtin_ctzll(bits);
+                long long distance = llabs(baseRow + r - row) + llabs(baseCol + c - col);
+                if (best < 0 || distance < best) {
+                    best = distance;
+                    row = baseRow + r;
+                    col = baseCol + c;
+                }
+            }
+        }
+        return best >= 0;
+    }
+    
+    // Игра в окне viewRows x viewCols; координаты команд - внутри окна, окно сдвигается WASD
+    void play(int viewRows, int viewCols) {
+        long long startRow = 0, startCol = 0;
+        if (findStart(startRow, startCol)) revealCell(startRow, startCol);
+        long long top = startRow - viewRows / 2, left = startCol - viewCols / 2;
+        
+        string message;
+        bool lost = false;
+        renderer.reset();
+        
+        while (true) {
+            vector<char> symbols((size_t)viewRows * viewCols);
+            for (int i = 0; i < viewRows; i++) {
+                for (int j = 0; j < viewCols; j++) {
+                    symbols[(size_t)i * viewCols + j] = cellSymbol(top + i, left + j, lost);
+                }
+            }
+            string title = "БЕСКОНЕЧНОЕ ПОЛЕ: окно со строки " + to_string(top) + ", столбца " + to_string(left) +
+                           ", зерно " + to_string(seed);
+            renderer.render(symbols, viewRows, viewCols, title,
+                            {"Открыто клеток: " + to_string(revealedCount) + ", фрагментов в памяти: " +
+                             to_string(chunks.size()) + ", сохранено: " + to_string(stored.size()), message,
+                             "Команды: O <строка> <столбец> - открыть, F <строка> <столбец> - флаг, "
+                             "W/A/S/D - сдвиг окна, Q - выход"},
+                            cout);
+            message.clear();
+            if (lost) break;
+            
+            char command;
+            cout << "Введите команду: ";
+            cin >> command;
+            command = toupper(command);
+            
+            if (command == 'Q') {
+                cout << "Игра прервана." << endl;
+                break;
+            }
+            
+            if (command == 'W' || command == 'S') {
+                top += (command == 'W' ? -1 : 1) * max(1, viewRows / 2);
+            } else if (command == 'A' || command == 'D') {
+                left += (command == 'A' ? -1 : 1) * max(1, viewCols / 2);
+            } else if (command == 'O' || command == 'F') {
+                int row, col;
+                cin >> row >> col;
+                if (row < 0 || row >= viewRows || col < 0 || col >= viewCols) {
+                    message = "Неверные координаты! Попробуйте снова.";
+                } else if (command == 'O') {
+                    lost = !revealCell(top + row, left + col);
+                } else {
+                    toggleFlag(top + row, left + col);
+                }
+            } else {
+                message = "Неверная команда! Используйте O, F, W, A, S, D или Q.";
+            }
+        }
+        
+        if (lost) {
+            cout << "\n╔════════════════════════════════════════╗" << endl;
+            cout << "║           💥 БУМ! 💥                  ║" << endl;
+            cout << "║  Открыто клеток: " << setw(12) << revealedCount << "          ║" << endl;
+            cout << "╚════════════════════════════════════════╝" << endl;
+        }
+    }
+    
+    // Память под фрагменты: загруженные целиком и сохраненные открытые клетки с флагами
+    size_t memoryBytes() const {
+        return chunks.size() * (sizeof(Chunk) + sizeof(uint64_t) * 4) +
+               stored.size() * (2 * CHUNK * sizeof(uint64_t) + sizeof(uint64_t) * 6);
+    }
+};
+
+// Автоматический игрок. Видит только то, что видит человек: открытые числа и свои флаги.
+// Сначала применяет достоверные правила (одиночные ограничения, пары ограничений с общими
+// клетками, общее число мин), а когда они ничего не дают - открывает клетку с наименьшей
+// точной вероятностью мины (MineProbability). Обрабатываются только новые открытые клетки
+// и цифры на границе области
+class MinesweeperSolver {
+private:
+    struct Constraint {
+        int center;
+        int cells[8];
+        int size;
+        int mines;
+    };
+    
+    Minesweeper& game;
+    mt19937_64& rng;
+    int rows;
+    int cols;
+    vector<int> view;
+    BitBoard seen;
+    vector<int> active;
+    vector<Constraint> constraints;
+    vector<int> constraintAt;
+    vector<char> verdict;
+    vector<int> marked;
+    long long flags;
+    int guesses;
+    MineProbability probabilities;
+    
+    long long unknownCount() const {
+        return (long long)rows * cols - game.getRevealedCount() - flags;
+    }
+    
+    // Переносит в view клетки, открытые с прошлого хода, сразу по 64 клетки
+    void refreshView() {
+        const BitBoard& revealed = game.getRevealed();
+        for (int r = 0; r < rows; r++) {
+            const uint64_t* current = revealed.row(r);
+            uint64_t* known = seen.row(r);
+            for (int w = 0; w < seen.rowWords(); w++) {
+                uint64_t fresh = current[w] & ~known[w];
+                known[w] |= fresh;
+                while (fresh != 0) {
+                    int c = w * 64 + __builtin_ctzll(fresh);
+                    fresh &= fresh - 1;
+                    int value = game.countAdjacentMines(r, c);
+                    view[r * cols + c] = value;
+                    if (value > 0) active.push_back(r * cols + c);
+                }
+            }
+        }
+    }
+    
+    // Ограничение каждой открытой цифры: среди ее закрытых соседей ровно mines мин.
+    // Цифры без закрытых соседей больше не понадобятся и убираются из active
+    void buildConstraints() {
+        for (const Constraint& constraint : constraints) constraintAt[constraint.center] = -1;
+        constraints.clear();
+        
+        size_t kept = 0;
+        for (int center : active) {
+            int r = center / cols, c = center % cols;
+            Constraint constraint;
+            constraint.center = center;
+            constraint.size = 0;
+            constraint.mines = view[center];
+            for (int nr = max(0, r - 1); nr <= min(rows - 1, r + 1); nr++) {
+                for (int nc = max(0, c - 1); nc <= min(cols - 1, c + 1); nc++) {
+                    int neighbor = view[nr * cols + nc];
+                    if (neighbor == CELL_UNKNOWN) constraint.cells[constraint.size++] = nr * cols + nc;
+                    else if (neighbor == CELL_FLAG) constraint.mines--;
+                }
+            }
+            
+            if (constraint.size > 0) {
+                active[kept++] = center;
+                constraintAt[center] = constraints.size();
+                constraints.push_back(constraint);
+            }
+        }
+        active.resize(kept);
+    }
+    
+    // 1 - безопасная клетка, 2 - мина
+    void mark(const int* cells, int size, char value) {
+        for (int i = 0; i < size; i++) {
+            if (verdict[cells[i]] == 0) marked.push_back(cells[i]);
+            verdict[cells[i]] = value;
         }
     }
     
-    void displayField(bool showMines = false) {
-        cout << "\n   ";
-        for (int j = 0; j < cols; j++) {
-            cout << setw(3) << j;
+    // Пара ограничений A и B: если в B \ A мин столько же, сколько в нем клеток, то эти клетки -
+    // мины, а клетки A \ B безопасны. При A внутри B и равном числе мин безопасно все B \ A
+    void comparePair(const Constraint& a, const Constraint& b) {
+        int onlyA[8], onlyB[8];
+        int onlyASize = 0, onlyBSize = 0, common = 0;
+        
+        for (int i = 0; i < a.size; i++) {
+            if (find(b.cells, b.cells + b.size, a.cells[i]) != b.cells + b.size) common++;
+            else onlyA[onlyASize++] = a.cells[i];
+        }
+        if (common == 0) return;
+        for (int i = 0; i < b.size; i++) {
+            if (find(a.cells, a.cells + a.size, b.cells[i]) == a.cells + a.size) onlyB[onlyBSize++] = b.cells[i];
         }
-        cout << endl;
         
-        cout << "   ";
-        for (int j = 0; j < cols; j++) {
-            cout << "───";
+        if (onlyBSize > 0 && b.mines - a.mines == onlyBSize) {
+            mark(onlyB, onlyBSize, 2);
+            mark(onlyA, onlyASize, 1);
+        } else if (onlyASize == 0 && onlyBSize > 0 && b.mines == a.mines) {
+            mark(onlyB, onlyBSize, 1);
         }
-        cout << endl;
+    }
+    
+    bool deduce() {
+        long long minesLeft = game.getMineCount() - flags;
         
-        for (int i = 0; i < rows; i++) {
-            cout << setw(2) << i << "│";
-            
-            for (int j = 0; j < cols; j++) {
-                char cell;
-                
-                if (showMines) {
-                    cell = field[i][j];
-                } else {
-                    cell = display[i][j];
-                }
-                
-                if (cell == '*') {
-                    cout << " \033[1;31m*\033[0m ";
-                } else if (cell == 'F') {
-                    cout << " \033[1;33mF\033[0m ";
-                } else if (cell == '#') {
-                    cout << " \033[1;37m#\033[0m ";
-                } else if (cell == '0') {
-                    cout << "   ";
-                } else if (cell >= '1' && cell <= '8') {
-                    cout << " \033[1;3" << (cell - '0') << "m" << cell << "\033[0m ";
-                } else {
-                    cout << " " << cell << " ";
-                }
+        if (minesLeft == 0 || minesLeft == unknownCount()) {
+            for (int cell = 0; cell < rows * cols; cell++) {
+                if (view[cell] == CELL_UNKNOWN) mark(&cell, 1, minesLeft == 0 ? 1 : 2);
             }
-            cout << "│" << endl;
+            return apply();
         }
         
-        cout << "   ";
-        for (int j = 0; j < cols; j++) {
-            cout << "───";
+        for (const Constraint& constraint : constraints) {
+            if (constraint.mines == 0) mark(constraint.cells, constraint.size, 1);
+            else if (constraint.mines == constraint.size) mark(constraint.cells, constraint.size, 2);
         }
-        cout << endl;
+        if (apply()) return true;
         
-        cout << "\nМин осталось: " << mineCount - countFlags() << endl;
+        for (const Constraint& first : constraints) {
+            int r = first.center / cols, c = first.center % cols;
+            for (int nr = max(0, r - 2); nr <= min(rows - 1, r + 2); nr++) {
+                for (int nc = max(0, c - 2); nc <= min(cols - 1, c + 2); nc++) {
+                    int second = constraintAt[nr * cols + nc];
+                    if (second >= 0 && nr * cols + nc != first.center) comparePair(first, constraints[second]);
+                }
+            }
+        }
+        return apply();
     }
     
-    // Подсчет установленных флагов
-    int countFlags() {
-        int count = 0;
-        for (int i = 0; i < rows; i++) {
-            for (int j = 0; j < cols; j++) {
-                if (flagged[i][j]) count++;
+    bool apply() {
+        bool progress = !marked.empty();
+        for (int cell : marked) {
+            if (verdict[cell] == 2) {
+                game.toggleFlag(cell / cols, cell % cols);
+                view[cell] = CELL_FLAG;
+                flags++;
             }
         }
-        return count;
+        for (int cell : marked) {
+            if (verdict[cell] == 1 && !game.isGameOver()) game.revealCell(cell / cols, cell % cols);
+            verdict[cell] = 0;
+        }
+        marked.clear();
+        return progress;
     }
     
-    void play() {
-        cout << "\n╔════════════════════════════════════════╗" << endl;
-        cout << "║            ИГРА 'САПЁР'               ║" << endl;
-        cout << "╚════════════════════════════════════════╝" << endl;
-        cout << "Размер поля: " << rows << "x" << cols << endl;
-        cout << "Количество мин: " << mineCount << endl;
-        cout << "\nКоманды:" << endl;
-        cout << "  O <строка> <столбец> - открыть клетку" << endl;
-        cout << "  F <строка> <столбец> - поставить/убрать флаг" << endl;
-        cout << "  Q - выход из игры" << endl;
-        
-        while (!gameOver) {
-            displayField();
-            
-            char command;
-            int row, col;
-            
-            cout << "\nВведите команду: ";
-            cin >> command;
-            
-            command = toupper(command);
-            
-            if (command == 'Q') {
-                cout << "Игра прервана." << endl;
-                break;
-            }
-            
-            if (command == 'O' || command == 'F') {
-                cin >> row >> col;
-                
-                if (!isValid(row, col)) {
-                    cout << "Неверные координаты! Попробуйте снова." << endl;
-                    continue;
-                }
-                
-                if (command == 'O') {
-                    revealCell(row, col);
-                } else if (command == 'F') {
-                    toggleFlag(row, col);
-                }
-            } else {
-                cout << "Неверная команда! Используйте O, F или Q." << endl;
-            }
+public:
+    MinesweeperSolver(Minesweeper& g, mt19937_64& generator)
+        : game(g), rng(generator), rows(g.getRows()), cols(g.getCols()),
+          view(rows * cols, CELL_UNKNOWN), seen(rows, cols), constraintAt(rows * cols, -1),
+          verdict(rows * cols, 0), flags(0), guesses(0), probabilities(1) {}
+    
+    // Делает достоверные ходы, пока они есть; true, если партия не окончена (нужна догадка)
+    bool deduceAll() {
+        while (!game.isGameOver()) {
+            refreshView();
+            buildConstraints();
+            if (!deduce()) return true;
+        }
+        return false;
+    }
+    
+    // Доигрывает партию до конца, начиная с хода (row, col); возвращает true при победе.
+    // Флаги на поле ставит только сам игрок
+    bool play(int row, int col) {
+        game.revealCell(row, col);
+        while (deduceAll()) guess();
+        return game.isWon();
+    }
+    
+    const vector<int>& getView() const {
+        return view;
+    }
+    
+    // Когда достоверных выводов нет, открывается клетка с наименьшей точной вероятностью мины
+    void guess() {
+        vector<double> probability;
+        if (!probabilities.compute(view, rows, cols, game.getMineCount(), probability)) {
+            // Противоречивое состояние: вероятностей нет, выбор равновероятен среди закрытых клеток
+            probability.assign((size_t)rows * cols, 0.5);
         }
         
-        if (gameOver) {
-            displayField(true);
-            
-            if (won) {
-                cout << "\n╔════════════════════════════════════════╗" << endl;
-                cout << "║          🎉 ПОЗДРАВЛЯЕМ! 🎉           ║" << endl;
-                cout << "║         ВЫ ВЫИГРАЛИ!                 ║" << endl;
-                cout << "╚════════════════════════════════════════╝" << endl;
-            } else {
-                cout << "\n╔════════════════════════════════════════╗" << endl;
-                cout << "║           💥 БУМ! 💥                  ║" << endl;
-                cout << "║         ВЫ ПРОИГРАЛИ!                ║" << endl;
-                cout << "╚════════════════════════════════════════╝" << endl;
+        double best = 2.0;
+        int chosen = -1, ties = 0;
+        for (int cell = 0; cell < rows * cols; cell++) {
+            if (view[cell] != CELL_UNKNOWN) continue;
+            if (probability[cell] < best - 1e-12) {
+                best = probability[cell];
+                chosen = cell;
+                ties = 1;
+            } else if (probability[cell] < best + 1e-12 && rng() % ++ties == 0) {
+                chosen = cell;
             }
         }
+        
+        if (best > 1e-12) guesses++;
+        game.revealCell(chosen / cols, chosen % cols);
     }
     
-    void debugMode() {
-        cout << "\n=== РЕЖИМ ОТЛАДКИ (все мины видны) ===" << endl;
-        displayField(true);
+    int getGuesses() const {
+        return guesses;
     }
 };
 
@@ -312,17 +1924,17 @@ void selectDifficulty(int& rows, int& cols, int& mines) {
             mines = 99;
             break;
         case 4:
-            cout << "Введите количество строк (5-20): ";
+            cout << "Введите количество строк (5-" << MAX_BOARD_SIZE << "): ";
             cin >> rows;
-            cout << "Введите количество столбцов (5-20): ";
+            cout << "Введите количество столбцов (5-" << MAX_BOARD_SIZE << "): ";
             cin >> cols;
             cout << "Введите количество мин: ";
             cin >> mines;
             
             if (rows < 5) rows = 5;
-            if (rows > 20) rows = 20;
+            if (rows > MAX_BOARD_SIZE) rows = MAX_BOARD_SIZE;
             if (cols < 5) cols = 5;
-            if (cols > 20) cols = 20;
+            if (cols > MAX_BOARD_SIZE) cols = MAX_BOARD_SIZE;
             if (mines < 1) mines = 1;
             if (mines >= rows * cols) mines = rows * cols - 1;
             break;
@@ -333,12 +1945,656 @@ void selectDifficulty(int& rows, int& cols, int& mines) {
     }
 }
 
+template <typename Func>
+double measureMs(Func action) {
+    auto start = chrono::steady_clock::now();
+    action();
+    auto finish = chrono::steady_clock::now();
+    return chrono::duration<double, milli>(finish - start).count();
+}
+
+// Сравнение побитовых досок с поклеточными массивами: подсчет соседей и флагов
+void runBitBoardBenchmark() {
+    cout << "\n╔════════════════════════════════════════╗" << endl;
+    cout << "║      БЕНЧМАРК: БИТОВЫЕ ДОСКИ          ║" << endl;
+    cout << "╚════════════════════════════════════════╝" << endl;
+    cout << "\nнс на клетку              массивы    биты" << endl;
+    
+    struct Size { int rows, cols, repeats; };
+    for (Size size : {Size{16, 30, 20000}, Size{20, 20, 20000}, Size{1000, 1000, 5}}) {
+        int rows = size.rows, cols = size.cols;
+        vector<char> field((size_t)rows * cols);
+        vector<char> flags((size_t)rows * cols);
+        BitBoard mines(rows, cols), flagged(rows, cols);
+        BitBoard planes[4] = {BitBoard(rows, cols), BitBoard(rows, cols), BitBoard(rows, cols), BitBoard(rows, cols)};
+        
+        srand(12345);
+        for (int i = 0; i < rows; i++) {
+            for (int j = 0; j < cols; j++) {
+                if (rand() % 5 == 0) {
+                    field[(size_t)i * cols + j] = 1;
+                    mines.set(i, j);
+                }
+                if (rand() % 7 == 0) {
+                    flags[(size_t)i * cols + j] = 1;
+                    flagged.set(i, j);
+                }
+            }
+        }
+        
+        vector<char> counts((size_t)rows * cols);
+        double arrayMs = measureMs([&] {
+            for (int rep = 0; rep < size.repeats; rep++) {
+                for (int i = 0; i < rows; i++) {
+                    for (int j = 0; j < cols; j++) {
+                        int count = 0;
+                        for (int dr = -1; dr <= 1; dr++) {
+                            for (int dc = -1; dc <= 1; dc++) {
+                                if (dr == 0 && dc == 0) continue;
+                                int r = i + dr, c = j + dc;
+                                if (r >= 0 && r < rows && c >= 0 && c < cols && field[(size_t)r * cols + c]) count++;
+                            }
+                        }
+                        counts[(size_t)i * cols + j] = count;
+                    }
+                }
+            }
+        });
+        double bitMs = measureMs([&] {
+            for (int rep = 0; rep < size.repeats; rep++) countNeighbors(mines, rows, planes);
+        });
+        
+        bool same = true;
+        for (int i = 0; i < rows; i++) {
+            for (int j = 0; j < cols; j++) {
+                int count = planes[0].test(i, j) | planes[1].test(i, j) << 1 |
+                            planes[2].test(i, j) << 2 | planes[3].test(i, j) << 3;
+                if (count != counts[(size_t)i * cols + j]) same = false;
+            }
+        }
+        
+        long long arrayFlags = 0, bitFlags = 0;
+        double arrayFlagMs = measureMs([&] {
+            for (int rep = 0; rep < size.repeats; rep++) {
+                for (char flag : flags) {
+                    if (flag) arrayFlags++;
+                }
+            }
+        });
+        double bitFlagMs = measureMs([&] {
+            for (int rep = 0; rep < size.repeats; rep++) bitFlags += flagged.count();
+        });
+        
+        double cells = (double)rows * cols * size.repeats;
+        cout << "Поле " << rows << "x" << cols << (same && arrayFlags == bitFlags ? "" : "  РАСХОЖДЕНИЕ!") << endl;
+        cout << fixed << setprecision(3);
+        cout << "  Числа соседей:      " << setw(10) << arrayMs * 1e6 / cells << setw(8) << bitMs * 1e6 / cells << endl;
+        cout << "  Подсчет флагов:     " << setw(10) << arrayFlagMs * 1e6 / cells << setw(8) << bitFlagMs * 1e6 / cells << endl;
+        cout << defaultfloat;
+    }
+}
+
+// Раскрытие больших пустых областей на полях произвольного размера
+void runFloodFillBenchmark() {
+    cout << "\n╔════════════════════════════════════════╗" << endl;
+    cout << "║      БЕНЧМАРК: РАСКРЫТИЕ ОБЛАСТИ      ║" << endl;
+    cout << "╚════════════════════════════════════════╝" << endl;
+    
+    for (int size : {1000, 3000, 10000}) {
+        long long mineTotal = (long long)size * size / 5000;
+        Minesweeper* game = nullptr;
+        double createMs = measureMs([&] {
+            game = new Minesweeper(size, size, mineTotal);
+            game->placeMines();
+        });
+        
+        int row = size / 2, col = size / 2;
+        while (game->cellSymbol(row, col, true) != '0') {
+            if (++col == size) {
+                col = 0;
+                row = (row + 1) % size;
+            }
+        }
+        
+        double revealMs = measureMs([&] { game->revealCell(row, col); });
+        long long opened = game->getRevealedCount();
+        
+        cout << "\nПоле " << size << "x" << size << ", мин: " << mineTotal << endl;
+        cout << fixed << setprecision(1);
+        cout << "  Создание:  " << createMs << " мс" << endl;
+        cout << "  Раскрытие: " << opened << " клеток за " << revealMs << " мс ("
+             << opened / (revealMs / 1000) / 1e6 << " млн клеток/с)" << endl;
+        cout << defaultfloat;
+        delete game;
+    }
+}
+
+// Прежняя расстановка (rand с отбраковкой занятых клеток) против выборки Флойда;
+// в оба замера входит создание поля и подсчет чисел
+void runGenerationBenchmark() {
+    cout << "\n╔════════════════════════════════════════╗" << endl;
+    cout << "║      БЕНЧМАРК: ГЕНЕРАЦИЯ ПОЛЯ         ║" << endl;
+    cout << "╚════════════════════════════════════════╝" << endl;
+    cout << "\nмкс на поле                        отбраковка   выборка" << endl;
+    
+    struct Case { int rows, cols; long long mines; int repeats; };
+    for (Case test : {Case{16, 30, 99, 2000}, Case{16, 30, 470, 2000}, Case{1000, 1000, 100000, 3},
+                      Case{1000, 1000, 990000, 3}}) {
+        BitBoard field(test.rows, test.cols);
+        long long cells = (long long)test.rows * test.cols;
+        
+        long long check = 0;
+        double rejectionMs = measureMs([&] {
+            srand(1);
+            for (int rep = 0; rep < test.repeats; rep++) {
+                field.clear();
+                long long placed = 0;
+                while (placed < test.mines) {
+                    long long cell = ((long long)rand() * (RAND_MAX + 1LL) + rand()) % cells;
+                    int r = cell / test.cols, c = cell % test.cols;
+                    if (!field.test(r, c)) {
+                        field.set(r, c);
+                        placed++;
+                    }
+                }
+                Minesweeper game(test.rows, test.cols, field);
+                check += game.cellSymbol(test.rows / 2, test.cols / 2, true);
+            }
+        });
+        
+        double shuffleMs = measureMs([&] {
+            for (int rep = 0; rep < test.repeats; rep++) {
+                Minesweeper game(test.rows, test.cols, test.mines, rep);
+                game.placeMines(test.rows / 2, test.cols / 2);
+                check += game.cellSymbol(test.rows / 2, test.cols / 2, true);
+            }
+        });
+        
+        cout << "Поле " << setw(4) << test.rows << "x" << setw(4) << test.cols << ", мин " << setw(6) << test.mines
+             << fixed << setprecision(1) << setw(14) << rejectionMs * 1000 / test.repeats
+             << setw(15) << shuffleMs * 1000 / test.repeats << (check > 0 ? "" : " ") << endl;
+        cout << defaultfloat;
+    }
+    
+    Minesweeper first(16, 30, 99, 42), second(16, 30, 99, 42);
+    first.placeMines(8, 15);
+    second.placeMines(8, 15);
+    bool same = true;
+    for (int r = 0; r < 16; r++) {
+        for (int c = 0; c < 30; c++) {
+            if (first.cellSymbol(r, c, true) != second.cellSymbol(r, c, true)) same = false;
+        }
+    }
+    cout << "\nОдно зерно дает одно поле: " << (same ? "да" : "НЕТ") << endl;
+}
+
+// Наивный перебор всех расстановок мин в клетках границы - для сравнения с MineProbability
+vector<double> naiveProbabilities(const vector<int>& view, int rows, int cols, long long mineCount) {
+    vector<int> frontier;
+    long long flags = 0, interior = 0;
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < cols; c++) {
+            int value = view[r * cols + c];
+            if (value == CELL_FLAG) flags++;
+            if (value != CELL_UNKNOWN) continue;
+            bool nearNumber = false;
+            for (int nr = max(0, r - 1); nr <= min(rows - 1, r + 1); nr++) {
+                for (int nc = max(0, c - 1); nc <= min(cols - 1, c + 1); nc++) {
+                    if (view[nr * cols + nc] > 0) nearNumber = true;
+                }
+            }
+            if (nearNumber) frontier.push_back(r * cols + c);
+            else interior++;
+        }
+    }
+    
+    vector<char> mine(rows * cols, 0);
+    for (int cell = 0; cell < rows * cols; cell++) mine[cell] = view[cell] == CELL_FLAG;
+    vector<double> sums(rows * cols, 0.0);
+    double total = 0, interiorMines = 0;
+    long long minesLeft = mineCount - flags;
+    
+    for (uint64_t mask = 0; mask < (uint64_t)1 << frontier.size(); mask++) {
+        long long placed = 0;
+        for (size_t i = 0; i < frontier.size(); i++) {
+            mine[frontier[i]] = mask >> i & 1;
+            placed += mask >> i & 1;
+        }
+        long long rest = minesLeft - placed;
+        if (rest < 0 || rest > interior) continue;
+        
+        bool consistent = true;
+        for (int r = 0; r < rows && consistent; r++) {
+            for (int c = 0; c < cols && consistent; c++) {
+                int value = view[r * cols + c];
+                if (value < 0) continue;
+                int around = 0;
+                for (int nr = max(0, r - 1); nr <= min(rows - 1, r + 1); nr++) {
+                    for (int nc = max(0, c - 1); nc <= min(cols - 1, c + 1); nc++) around += mine[nr * cols + nc];
+                }
+                consistent = around == value;
+            }
+        }
+        if (!consistent) continue;
+        
+        double weight = exp(lgamma(interior + 1.0) - lgamma(rest + 1.0) - lgamma(interior - rest + 1.0));
+        total += weight;
+        interiorMines += weight * rest;
+        for (int cell : frontier) {
+            if (mine[cell]) sums[cell] += weight;
+        }
+    }
+    
+    vector<double> probability(rows * cols, 0.0);
+    for (int cell = 0; cell < rows * cols; cell++) {
+        if (view[cell] == CELL_FLAG) probability[cell] = 1.0;
+        else if (view[cell] == CELL_UNKNOWN) probability[cell] = interior > 0 ? interiorMines / total / interior : 0.0;
+    }
+    for (int cell : frontier) probability[cell] = sums[cell] / total;
+    return probability;
+}
+
+// Точные вероятности на позициях, где автоматическому игроку пришлось угадывать:
+// без кэша в один поток и во все ядра, с кэшем компонент в пределах партии и наивный перебор
+void runProbabilityBenchmark() {
+    cout << "\n╔════════════════════════════════════════╗" << endl;
+    cout << "║      БЕНЧМАРК: ВЕРОЯТНОСТИ МИН        ║" << endl;
+    cout << "╚════════════════════════════════════════╝" << endl;
+    
+    struct Level { const char* name; int rows, cols, mines, games; };
+    for (Level level : {Level{"Профи 16x30, 99 мин", 16, 30, 99, 300}, Level{"Поле 64x64, 844 мины", 64, 64, 844, 20}}) {
+        vector<vector<int>> positions;
+        vector<int> gameOf;
+        mt19937_64 rng(2024);
+        for (int g = 0; g < level.games; g++) {
+            Minesweeper game(level.rows, level.cols, level.mines, rng());
+            MinesweeperSolver solver(game, rng);
+            game.revealCell(level.rows / 2, level.cols / 2);
+            while (solver.deduceAll()) {
+                positions.push_back(solver.getView());
+                gameOf.push_back(g);
+                solver.guess();
+            }
+        }
+        
+        auto frontierSize = [&](const vector<int>& view) {
+            int size = 0;
+            for (int cell = 0; cell < level.rows * level.cols; cell++) {
+                if (view[cell] != CELL_UNKNOWN) continue;
+                int r = cell / level.cols, c = cell % level.cols;
+                bool nearNumber = false;
+                for (int nr = max(0, r - 1); nr <= min(level.rows - 1, r + 1); nr++) {
+                    for (int nc = max(0, c - 1); nc <= min(level.cols - 1, c + 1); nc++) {
+                        if (view[nr * level.cols + nc] > 0) nearNumber = true;
+                    }
+                }
+                size += nearNumber;
+            }
+            return size;
+        };
+        
+        long long components = 0, frontier = 0;
+        vector<double> probability;
+        for (const vector<int>& view : positions) {
+            int count = 0;
+            MineProbability(1).compute(view, level.rows, level.cols, level.mines, probability, &count);
+            components += count;
+            frontier += frontierSize(view);
+        }
+        
+        auto timePerPosition = [&](int threads, bool cached) {
+            MineProbability engine(threads);
+            double ms = measureMs([&] {
+                for (size_t i = 0; i < positions.size(); i++) {
+                    if (!cached || (i > 0 && gameOf[i] != gameOf[i - 1])) engine.clearCache();
+                    engine.compute(positions[i], level.rows, level.cols, level.mines, probability);
+                }
+            });
+            return ms * 1000 / positions.size();
+        };
+        
+        double singleUs = timePerPosition(1, false);
+        double parallelUs = timePerPosition(0, false);
+        double cachedUs = timePerPosition(1, true);
+        
+        // Наивный перебор экспоненциален, поэтому сравнение - на позициях с границей до 16 клеток
+        int compared = 0;
+        double naiveMs = 0, engineMs = 0, maxError = 0;
+        for (const vector<int>& view : positions) {
+            if (compared == 100 || frontierSize(view) > 16) continue;
+            vector<double> exact, naive;
+            engineMs += measureMs([&] { MineProbability(1).compute(view, level.rows, level.cols, level.mines, exact); });
+            naiveMs += measureMs([&] { naive = naiveProbabilities(view, level.rows, level.cols, level.mines); });
+            for (int cell = 0; cell < level.rows * level.cols; cell++) {
+                maxError = max(maxError, fabs(exact[cell] - naive[cell]));
+            }
+            compared++;
+        }
+        
+        cout << "\n" << level.name << ": позиций " << positions.size() << fixed << setprecision(1)
+             << ", в среднем клеток границы " << (double)frontier / positions.size()
+             << ", компонент " << (double)components / positions.size() << endl;
+        cout << "  Без кэша, 1 поток:    " << setw(10) << singleUs << " мкс на позицию" << endl;
+        cout << "  Без кэша, все ядра:   " << setw(10) << parallelUs << " мкс на позицию" << endl;
+        cout << "  С кэшем компонент:    " << setw(10) << cachedUs << " мкс на позицию" << endl;
+        if (compared > 0) {
+            cout << "  Наивный перебор (" << compared << " позиций с границей до 16 клеток): "
+                 << naiveMs * 1000 / compared << " мкс против " << engineMs * 1000 / compared
+                 << " мкс, расхождение " << scientific << setprecision(1) << maxError << endl;
+        }
+        cout << defaultfloat;
+    }
+}
+
+// Вывод за ход при полной перерисовке кадра и при выводе только изменений.
+// Ходы - открытия случайных безопасных клеток, вывод идет в строковый поток
+void runRenderBenchmark() {
+    cout << "\n╔════════════════════════════════════════╗" << endl;
+    cout << "║      БЕНЧМАРК: ОТРИСОВКА ПОЛЯ         ║" << endl;
+    cout << "╚════════════════════════════════════════╝" << endl;
+    cout << "\n                        байт на ход            мкс на ход" << endl;
+    cout << "Поле                 полный   разница      полный   разница" << endl;
+    
+    for (int size : {30, 100, 300}) {
+        Minesweeper game(size, size, (long long)size * size / 6, 7);
+        game.placeMines(size / 2, size / 2);
+        mt19937_64 rng(7);
+        
+        vector<pair<int, int>> moves;
+        while (moves.size() < 100) {
+            int row = rng() % size, col = rng() % size;
+            if (game.cellSymbol(row, col, true) != '*') moves.push_back({row, col});
+        }
+        
+        // Кадры одних и тех же ходов: в первом проходе каждый кадр полный, во втором - разница
+        double fullMs = 0, diffMs = 0;
+        size_t fullBytes = 0, diffBytes = 0;
+        for (int pass = 0; pass < 2; pass++) {
+            Minesweeper replay(size, size, (long long)size * size / 6, 7);
+            replay.placeMines(size / 2, size / 2);
+            ostringstream sink;
+            replay.displayField(false, "", sink);
+            
+            for (auto move : moves) {
+                replay.revealCell(move.first, move.second);
+                sink.str("");
+                double ms = measureMs([&] {
+                    if (pass == 0) replay.resetDisplay();
+                    replay.displayField(false, "", sink);
+                });
+                (pass == 0 ? fullMs : diffMs) += ms;
+                (pass == 0 ? fullBytes : diffBytes) += replay.lastFrameBytes();
+            }
+        }
+        
+        cout << "Поле " << setw(3) << size << "x" << setw(3) << size << "     " << setw(12) << fullBytes / moves.size()
+             << setw(10) << diffBytes / moves.size() << fixed << setprecision(1)
+             << setw(12) << fullMs * 1000 / moves.size() << setw(10) << diffMs * 1000 / moves.size() << endl;
+        cout << defaultfloat;
+    }
+}
+
+// Итог партии в журнале ходов: 0 - проигрыш, 1 - победа, 2 - не доиграна
+int gameResult(const Minesweeper& game) {
+    return game.isGameOver() ? (game.isWon() ? 1 : 0) : 2;
+}
+
+// Автоигра на стандартных уровнях: партии делятся между всеми ядрами,
+// у каждого потока свой генератор, первый (безопасный) ход - в центр поля
+void runSolverSimulation() {
+    cout << "\n╔════════════════════════════════════════╗" << endl;
+    cout << "║      СИМУЛЯЦИЯ: АВТОМАТИЧЕСКИЙ ИГРОК  ║" << endl;
+    cout << "╚════════════════════════════════════════╝" << endl;
+    cout << "Введите количество партий на уровень: ";
+    
+    long long games;
+    cin >> games;
+    if (games < 1) games = 1;
+    
+    cout << "Файл журнала ходов (- без журнала): ";
+    string logPath;
+    cin >> logPath;
+    bool logging = logPath != "-";
+    mutex logMutex;
+    
+    int threads = max(1u, thread::hardware_concurrency());
+    cout << "Потоков: " << threads << endl;
+    cout << "\nУровень      Партий     Побед, %   Угадываний   Партий/с" << endl;
+    
+    struct Level { const char* name; int rows, cols, mines; };
+    for (Level level : {Level{"Новичок ", 9, 9, 10}, Level{"Любитель", 16, 16, 40}, Level{"Профи   ", 16, 30, 99}}) {
+        vector<long long> wins(threads, 0), guesses(threads, 0);
+        
+        double elapsedMs = measureMs([&] {
+            vector<thread> workers;
+            for (int t = 0; t < threads; t++) {
+                workers.emplace_back([&, t] {
+                    mt19937_64 rng(0x9E3779B97F4A7C15ULL * (t + 1) + level.mines);
+                    long long share = games / threads + (t < games % threads ? 1 : 0);
+                    int row = level.rows / 2, col = level.cols / 2;
+                    
+                    MoveLog log;
+                    
+                    for (long long i = 0; i < share; i++) {
+                        Minesweeper game(level.rows, level.cols, level.mines, rng());
+                        if (logging) game.setMoveLog(&log);
+                        MinesweeperSolver solver(game, rng);
+                        if (solver.play(row, col)) wins[t]++;
+                        guesses[t] += solver.getGuesses();
+                        
+                        if (logging) {
+                            log.endGame(gameResult(game));
+                            if (log.size() > (1 << 20) || i + 1 == share) {
+                                lock_guard<mutex> lock(logMutex);
+                                log.appendTo(logPath);
+                            }
+                        }
+                    }
+                });
+            }
+            for (thread& worker : workers) worker.join();
+        });
+        
+        long long totalWins = 0, totalGuesses = 0;
+        for (int t = 0; t < threads; t++) {
+            totalWins += wins[t];
+            totalGuesses += guesses[t];
+        }
+        
+        cout << fixed << setprecision(2);
+        cout << level.name << setw(12) << games << setw(13) << 100.0 * totalWins / games
+             << setw(13) << (double)totalGuesses / games << setw(11) << setprecision(0)
+             << games / (elapsedMs / 1000) << endl;
+        cout << defaultfloat;
+    }
+}
+
+// Воспроизводит партию журнала, начиная с записи 'G' на позиции pos; pos сдвигается за ее
+// запись 'E'. Возвращает nullptr, если запись повреждена; logged - записанный итог
+unique_ptr<Minesweeper> replayGame(const string& log, size_t& pos, int& logged, long long& moves) {
+    uint64_t fields[4];
+    if (pos >= log.size() || log[pos++] != 'G') return nullptr;
+    for (uint64_t& field : fields) {
+        if (!readVarint(log, pos, field)) return nullptr;
+    }
+    if (fields[0] < 1 || fields[0] > MAX_BOARD_SIZE || fields[1] < 1 || fields[1] > MAX_BOARD_SIZE) return nullptr;
+    
+    unique_ptr<Minesweeper> game(new Minesweeper(fields[0], fields[1], fields[2], fields[3]));
+    while (pos < log.size()) {
+        char type = log[pos++];
+        if (type == 'E') {
+            if (pos >= log.size()) return nullptr;
+            logged = log[pos++];
+            return game;
+        }
+        
+        uint64_t row, col;
+        if ((type != 'O' && type != 'F') || !readVarint(log, pos, row) || !readVarint(log, pos, col)) return nullptr;
+        if (type == 'O') game->revealCell(row, col);
+        else game->toggleFlag(row, col);
+        moves++;
+    }
+    return nullptr;
+}
+
+// Воспроизведение журнала ходов (например, записанного симуляцией) для проверки, что после
+// изменений те же ходы на тех же полях дают те же итоги. Партии делятся между всеми ядрами
+void runReplay() {
+    cout << "\n╔════════════════════════════════════════╗" << endl;
+    cout << "║      ВОСПРОИЗВЕДЕНИЕ ЖУРНАЛА ХОДОВ    ║" << endl;
+    cout << "╚════════════════════════════════════════╝" << endl;
+    cout << "Файл журнала: ";
+    
+    string path;
+    cin >> path;
+    ifstream file(path, ios::binary);
+    if (!file) {
+        cout << "Не удалось открыть " << path << endl;
+        return;
+    }
+    string log((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    
+    // Начала партий; разбор останавливается на первой поврежденной записи
+    vector<size_t> starts;
+    size_t scan = 0;
+    while (scan < log.size() && log[scan] == 'G') {
+        size_t start = scan++;
+        uint64_t value;
+        bool valid = true;
+        for (int i = 0; i < 4 && valid; i++) valid = readVarint(log, scan, value);
+        while (valid && scan < log.size() && log[scan] != 'E') {
+            scan++;
+            valid = readVarint(log, scan, value) && readVarint(log, scan, value);
+        }
+        if (!valid || scan + 2 > log.size()) break;
+        scan += 2;
+        starts.push_back(start);
+    }
+    if (scan < log.size()) {
+        cout << "Журнал поврежден после партии " << starts.size() << ", остаток пропущен" << endl;
+    }
+    
+    int threads = max(1u, thread::hardware_concurrency());
+    vector<long long> moveCounts(threads, 0), mismatches(threads, 0), broken(threads, 0);
+    vector<vector<size_t>> failed(threads);
+    
+    double elapsedMs = measureMs([&] {
+        vector<thread> workers;
+        for (int t = 0; t < threads; t++) {
+            workers.emplace_back([&, t] {
+                for (size_t g = t; g < starts.size(); g += threads) {
+                    size_t pos = starts[g];
+                    int logged = 2;
+                    unique_ptr<Minesweeper> game = replayGame(log, pos, logged, moveCounts[t]);
+                    if (!game) {
+                        broken[t]++;
+                    } else if (gameResult(*game) != logged) {
+                        mismatches[t]++;
+                        if (failed[t].size() < 5) failed[t].push_back(g);
+                    }
+                }
+            });
+        }
+        for (thread& worker : workers) worker.join();
+    });
+    
+    long long totalMoves = 0, totalMismatches = 0, totalBroken = 0;
+    for (int t = 0; t < threads; t++) {
+        totalMoves += moveCounts[t];
+        totalMismatches += mismatches[t];
+        totalBroken += broken[t];
+    }
+    
+    cout << "\nПартий: " << starts.size() << ", ходов: " << totalMoves << ", размер журнала: " << log.size() << " байт" << endl;
+    cout << fixed << setprecision(1) << "Время: " << elapsedMs << " мс (" << setprecision(0)
+         << starts.size() / (elapsedMs / 1000) << " партий/с)" << defaultfloat << endl;
+    cout << "Расхождений итога: " << totalMismatches << ", поврежденных записей: " << totalBroken << endl;
+    for (int t = 0; t < threads; t++) {
+        for (size_t g : failed[t]) cout << "  расхождение в партии " << g << endl;
+    }
+    
+    cout << "\nНомер партии для просмотра (-1 - пропустить): ";
+    long long shown;
+    cin >> shown;
+    if (shown < 0 || shown >= (long long)starts.size()) return;
+    
+    size_t pos = starts[shown];
+    int logged = 2;
+    long long moves = 0;
+    unique_ptr<Minesweeper> game = replayGame(log, pos, logged, moves);
+    if (!game) return;
+    game->displayField(true);
+    cout << "Ходов: " << moves << ", итог в журнале: " << logged << ", при воспроизведении: " << gameResult(*game)
+         << " (0 - проигрыш, 1 - победа, 2 - не доиграна)" << endl;
+}
+
+// Нагрузочный режим бесконечного поля: игрок случайно блуждает по полю и открывает клетку
+// на каждом шаге (подрывы не останавливают прогон). Показывает, что число фрагментов в памяти
+// ограничено радиусом вокруг игрока, а остальная память растет с исследованной площадью
+void runInfiniteStress() {
+    cout << "\n╔════════════════════════════════════════╗" << endl;
+    cout << "║   НАГРУЗКА: БЕСКОНЕЧНОЕ ПОЛЕ          ║" << endl;
+    cout << "╚════════════════════════════════════════╝" << endl;
+    
+    long long moves;
+    int step;
+    cout << "\nЧисло ходов: ";
+    cin >> moves;
+    cout << "Наибольший шаг игрока (клеток): ";
+    cin >> step;
+    if (moves <= 0 || step <= 0) {
+        cout << "Неверные параметры." << endl;
+        return;
+    }
+    
+    InfiniteField field(2024, 0.2);
+    Xoshiro256 rng(7);
+    long long row = 0, col = 0, done = 0;
+    long long minRow = 0, maxRow = 0, minCol = 0, maxCol = 0;
+    
+    cout << "\n     ходов    открыто клеток   в памяти  сохранено  создано    память, КБ   мкс/ход" << endl;
+    for (int part = 1; part <= 5; part++) {
+        long long target = moves * part / 5;
+        long long count = target - done;
+        double ms = measureMs([&] {
+            for (; done < target; done++) {
+                row += (long long)rng.below(2 * step + 1) - step;
+                col += (long long)rng.below(2 * step + 1) - step;
+                field.revealCell(row, col);
+                minRow = min(minRow, row);
+                maxRow = max(maxRow, row);
+                minCol = min(minCol, col);
+                maxCol = max(maxCol, col);
+            }
+        });
+        
+        cout << setw(10) << done << setw(18) << field.getRevealedCount() << setw(11) << field.getLoadedChunks()
+             << setw(11) << field.getStoredChunks() << setw(9) << field.getGeneratedChunks()
+             << setw(14) << field.memoryBytes() / 1024 << fixed << setprecision(2)
+             << setw(10) << (count > 0 ? ms * 1000 / count : 0.0) << endl;
+        cout << defaultfloat;
+    }
+    
+    cout << "\nПодрывов: " << field.getExplosions() << ", игрок побывал в строках " << minRow << ".." << maxRow
+         << " и столбцах " << minCol << ".." << maxCol << endl;
+}
+
 void displayMainMenu() {
     cout << "\n╔════════════════════════════════════════╗" << endl;
     cout << "║            ГЛАВНОЕ МЕНЮ               ║" << endl;
     cout << "╚════════════════════════════════════════╝" << endl;
     cout << "1. Новая игра" << endl;
     cout << "2. Правила игры" << endl;
+    cout << "3. Бенчмарк битовых досок" << endl;
+    cout << "4. Бенчмарк раскрытия области" << endl;
+    cout << "5. Симуляция автоматического игрока" << endl;
+    cout << "6. Бенчмарк генерации поля" << endl;
+    cout << "7. Бенчмарк вероятностей мин" << endl;
+    cout << "8. Бенчмарк отрисовки поля" << endl;
+    cout << "9. Продолжить сохраненную партию" << endl;
+    cout << "10. Воспроизвести журнал ходов" << endl;
+    cout << "11. Бесконечное поле" << endl;
+    cout << "12. Нагрузочный режим бесконечного поля" << endl;
     cout << "0. Выход" << endl;
     cout << "───────────────────────────────────────" << endl;
     cout << "Выберите действие: ";
@@ -349,6 +2605,7 @@ void showRules() {
     cout << "║           ПРАВИЛА ИГРЫ                ║" << endl;
     cout << "╚════════════════════════════════════════╝" << endl;
     cout << "\nЦель: Открыть все клетки без мин." << endl;
+    cout << "Первый ход всегда безопасен." << endl;
     cout << "\nУсловные обозначения:" << endl;
     cout << "  # - Закрытая клетка" << endl;
     cout << "  F - Флаг (отметка возможной мины)" << endl;
@@ -360,6 +2617,7 @@ void showRules() {
     cout << "  2. Ставьте флаги на мины командой F" << endl;
     cout << "  3. Используйте числа для логики" << endl;
     cout << "  4. Откройте все клетки без мин для победы" << endl;
+    cout << "  5. Если не уверены, команда H подскажет самую безопасную клетку" << endl;
     cout << "\nСовет: Начинайте с углов!" << endl;
 }
 
@@ -384,6 +2642,56 @@ int main() {
             case 2:
                 showRules();
                 break;
+            case 3:
+                runBitBoardBenchmark();
+                break;
+            case 4:
+                runFloodFillBenchmark();
+                break;
+            case 5:
+                runSolverSimulation();
+                break;
+            case 6:
+                runGenerationBenchmark();
+                break;
+            case 7:
+                runProbabilityBenchmark();
+                break;
+            case 8:
+                runRenderBenchmark();
+                break;
+            case 9: {
+                cout << "Файл сохранения: ";
+                string path;
+                cin >> path;
+                ifstream file(path, ios::binary);
+                Minesweeper game;
+                if (file && game.loadSnapshot(file)) {
+                    game.play();
+                } else {
+                    cout << "Не удалось загрузить " << path << endl;
+                }
+                break;
+            }
+            case 10:
+                runReplay();
+                break;
+            case 11: {
+                double density;
+                cout << "Доля мин (от 0.15 до 0.5): ";
+                cin >> density;
+                if (density < 0.15 || density > 0.5) {
+                    cout << "Неверная доля мин." << endl;
+                    break;
+                }
+                
+                InfiniteField field(randomSeed(), density);
+                field.play(16, 30);
+                break;
+            }
+            case 12:
+                runInfiniteStress();
+                break;
             case 0:
                 cout << "\nСпасибо за игру! До встречи!" << endl;
                 break;
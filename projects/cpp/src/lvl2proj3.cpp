@@ -3,38 +3,135 @@
 #include <ctime>
 #include <stack>
 #include <iomanip>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <unordered_set>
 
 using namespace std;
 
+// Пул объектов одного типа: память берется слабами по SLAB объектов, освобожденные ячейки
+// уходят в список свободных и отдаются следующему create без обращения к malloc
+template <typename T>
+class Pool {
+private:
+    union Slot {
+        Slot* next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+    
+    static const int SLAB = 256;
+    vector<unique_ptr<Slot[]>> slabs;
+    Slot* freeList = nullptr;
+    size_t live = 0;
+    
+public:
+    Pool() {}
+    Pool(const Pool&) = delete;
+    Pool& operator=(const Pool&) = delete;
+    
+    template <typename... Args>
+    T* create(Args&&... args) {
+        if (freeList == nullptr) {
+            slabs.emplace_back(new Slot[SLAB]);
+            Slot* slab = slabs.back().get();
+            for (int i = 0; i < SLAB; i++) slab[i].next = i + 1 < SLAB ? &slab[i + 1] : nullptr;
+            freeList = slab;
+        }
+        
+        Slot* slot = freeList;
+        freeList = slot->next;
+        live++;
+        return new (slot->storage) T(std::forward<Args>(args)...);
+    }
+    
+    void destroy(T* object) {
+        object->~T();
+        Slot* slot = reinterpret_cast<Slot*>(object);
+        slot->next = freeList;
+        freeList = slot;
+        live--;
+    }
+    
+    size_t getLive() const { return live; }
+    size_t getSlabs() const { return slabs.size(); }
+    size_t capacity() const { return slabs.size() * SLAB; }
+};
+
+// Арена строк: каждая разная строка хранится в блоках арены один раз, задачи и снимки
+// в истории ссылаются на нее через string_view. Блоки не освобождаются до конца работы
+class StringArena {
+private:
+    static const size_t BLOCK = 64 * 1024;
+    vector<unique_ptr<char[]>> blocks;
+    char* current = nullptr;
+    size_t left = 0;
+    size_t bytes = 0;
+    unordered_set<string_view> strings;
+    
+public:
+    StringArena() {}
+    StringArena(const StringArena&) = delete;
+    StringArena& operator=(const StringArena&) = delete;
+    
+    string_view intern(string_view text) {
+        auto found = strings.find(text);
+        if (found != strings.end()) return *found;
+        
+        char* place;
+        if (text.size() > BLOCK / 4) {
+            blocks.emplace_back(new char[text.size()]);
+            place = blocks.back().get();
+        } else {
+            if (left < text.size()) {
+                blocks.emplace_back(new char[BLOCK]);
+                current = blocks.back().get();
+                left = BLOCK;
+            }
+            place = current;
+            current += text.size();
+            left -= text.size();
+        }
+        
+        copy(text.begin(), text.end(), place);
+        bytes += text.size();
+        return *strings.insert(string_view(place, text.size())).first;
+    }
+    
+    size_t getStrings() const { return strings.size(); }
+    size_t getBytes() const { return bytes; }
+};
+
 struct Task {
     int id;
-    string description;
-    string priority;
+    string_view description;
+    string_view priority;
     bool completed;
     time_t createdAt;
     Task* next;
     Task* prev;
+    Task* bucketNext;
     
-    Task(int taskId, const string& desc, const string& prior = "Medium") 
+    Task(int taskId, string_view desc, string_view prior = "Medium") 
         : id(taskId), description(desc), priority(prior), 
-          completed(false), next(nullptr), prev(nullptr) {
+          completed(false), next(nullptr), prev(nullptr), bucketNext(nullptr) {
         createdAt = time(nullptr);
     }
 };
 
+// Снимок задачи хранится по значению: строки в нем - ссылки в арену, так что копия
+// не выделяет память
 struct Action {
     enum Type { ADD, REMOVE, COMPLETE, UNCOMPLETE };
     Type type;
-    Task* task;
-    
-    Action(Type t, Task* originalTask) : type(t) {
-        task = new Task(originalTask->id, originalTask->description, originalTask->priority);
-        task->completed = originalTask->completed;
-        task->createdAt = originalTask->createdAt;
-    }
+    Task task;
     
-    ~Action() {
-        delete task;
+    Action(Type t, const Task* originalTask) : type(t), task(*originalTask) {
+        task.next = task.prev = task.bucketNext = nullptr;
     }
 };
 
@@ -43,15 +140,20 @@ private:
     Task* head;
     Task* tail;
     int taskCounter;
-    stack<Action*> history;
+    stack<Action*, vector<Action*>> history;
+    vector<Task*> buckets;
+    int indexed;
+    Pool<Task> taskPool;
+    Pool<Action> actionPool;
+    StringArena strings;
     
 public:
-    ToDoList() : head(nullptr), tail(nullptr), taskCounter(0) {}
+    ToDoList() : head(nullptr), tail(nullptr), taskCounter(0), buckets(16, nullptr), indexed(0) {}
     
     ~ToDoList() {
         clear();
         while (!history.empty()) {
-            delete history.top();
+            actionPool.destroy(history.top());
             history.pop();
         }
     }
@@ -67,17 +169,7 @@ public:
         getline(cin, priority);
         if (priority.empty()) priority = "Medium";
         
-        Task* newTask = new Task(++taskCounter, desc, priority);
-        
-        if (head == nullptr) {
-            head = tail = newTask;
-        } else {
-            newTask->next = head;
-            head->prev = newTask;
-            head = newTask;
-        }
-        
-        history.push(new Action(Action::ADD, newTask));
+        Task* newTask = addTask(desc, priority, true);
         cout << "✓ Задача #" << newTask->id << " добавлена в начало списка" << endl;
     }
     
@@ -92,17 +184,7 @@ public:
         getline(cin, priority);
         if (priority.empty()) priority = "Medium";
         
-        Task* newTask = new Task(++taskCounter, desc, priority);
-        
-        if (tail == nullptr) {
-            head = tail = newTask;
-        } else {
-            tail->next = newTask;
-            newTask->prev = tail;
-            tail = newTask;
-        }
-        
-        history.push(new Action(Action::ADD, newTask));
+        Task* newTask = addTask(desc, priority, false);
         cout << "✓ Задача #" << newTask->id << " добавлена в конец списка" << endl;
     }
     
@@ -118,33 +200,12 @@ public:
         cout << "\nВведите ID задачи для удаления: ";
         cin >> id;
         
-        Task* current = head;
-        while (current != nullptr && current->id != id) {
-            current = current->next;
-        }
-        
-        if (current == nullptr) {
+        if (!removeById(id)) {
             cout << "Задача с ID " << id << " не найдена!" << endl;
             return;
         }
         
-        history.push(new Action(Action::REMOVE, current));
-        
-        if (current == head && current == tail) {
-            head = tail = nullptr;
-        } else if (current == head) {
-            head = head->next;
-            head->prev = nullptr;
-        } else if (current == tail) {
-            tail = tail->prev;
-            tail->next = nullptr;
-        } else {
-            current->prev->next = current->next;
-            current->next->prev = current->prev;
-        }
-        
         cout << "✓ Задача #" << id << " удалена" << endl;
-        delete current;
     }
     
     void toggleComplete() {
@@ -159,25 +220,68 @@ public:
         cout << "\nВведите ID задачи: ";
         cin >> id;
         
-        Task* current = head;
-        while (current != nullptr && current->id != id) {
-            current = current->next;
-        }
-        
+        Task* current = toggleById(id);
         if (current == nullptr) {
             cout << "Задача с ID " << id << " не найдена!" << endl;
             return;
         }
         
         if (current->completed) {
-            history.push(new Action(Action::UNCOMPLETE, current));
-            current->completed = false;
+            cout << "✓ Задача #" << id << " отмечена как выполненная" << endl;
+        } else {
             cout << "✓ Задача #" << id << " отмечена как невыполненная" << endl;
+        }
+    }
+    
+    // Операции без диалога: на них построены команды меню и бенчмарк
+    Task* addTask(const string& desc, const string& priority, bool atBeginning) {
+        Task* newTask = taskPool.create(++taskCounter, strings.intern(desc), strings.intern(priority));
+        if (atBeginning) {
+            linkFront(newTask);
         } else {
-            history.push(new Action(Action::COMPLETE, current));
-            current->completed = true;
-            cout << "✓ Задача #" << id << " отмечена как выполненная" << endl;
+            linkBack(newTask);
+        }
+        history.push(actionPool.create(Action::ADD, newTask));
+        return newTask;
+    }
+    
+    bool removeById(int id) {
+        Task* current = findTask(id);
+        if (current == nullptr) return false;
+        
+        history.push(actionPool.create(Action::REMOVE, current));
+        unlink(current);
+        taskPool.destroy(current);
+        return true;
+    }
+    
+    Task* toggleById(int id) {
+        Task* current = findTask(id);
+        if (current == nullptr) return nullptr;
+        
+        history.push(actionPool.create(current->completed ? Action::UNCOMPLETE : Action::COMPLETE, current));
+        current->completed = !current->completed;
+        return current;
+    }
+    
+    size_t poolSlabs() const {
+        return taskPool.getSlabs() + actionPool.getSlabs();
+    }
+    
+    Task* findTask(int id) const {
+        for (Task* task = buckets[id & (buckets.size() - 1)]; task != nullptr; task = task->bucketNext) {
+            if (task->id == id) return task;
         }
+        return nullptr;
+    }
+    
+    // Прежний поиск проходом по списку - для сравнения в бенчмарке
+    Task* findTaskLinear(int id) const {
+        Task* current = head;
+        while (current != nullptr && current->id != id) {
+            current = current->next;
+        }
+        return current;
     }
     
     void displayAll() {
@@ -253,82 +357,63 @@ public:
             return;
         }
         
+        string message;
+        undoLast(message);
+        if (!message.empty()) cout << message << endl;
+    }
+    
+    // Отмена последнего действия; false - история пуста. message - что отменено
+    // (остается пустым, если задачи уже нет); строка переиспользуется между вызовами
+    bool undoLast(string& message) {
+        if (history.empty()) return false;
+        
         Action* lastAction = history.top();
         history.pop();
+        message.clear();
         
         switch (lastAction->type) {
             case Action::ADD: {
-                Task* current = head;
-                while (current != nullptr && current->id != lastAction->task->id) {
-                    current = current->next;
-                }
+                Task* current = findTask(lastAction->task.id);
                 
                 if (current != nullptr) {
-                    if (current == head && current == tail) {
-                        head = tail = nullptr;
-                    } else if (current == head) {
-                        head = head->next;
-                        head->prev = nullptr;
-                    } else if (current == tail) {
-                        tail = tail->prev;
-                        tail->next = nullptr;
-                    } else {
-                        current->prev->next = current->next;
-                        current->next->prev = current->prev;
-                    }
-                    delete current;
-                    cout << "✓ Отменено: добавление задачи #" << lastAction->task->id << endl;
+                    unlink(current);
+                    taskPool.destroy(current);
+                    message.assign("✓ Отменено: добавление задачи #").append(to_string(lastAction->task.id));
                 }
                 break;
             }
             
             case Action::REMOVE: {
-                Task* restored = new Task(lastAction->task->id, 
-                                         lastAction->task->description, 
-                                         lastAction->task->priority);
-                restored->completed = lastAction->task->completed;
-                restored->createdAt = lastAction->task->createdAt;
-                
-                if (head == nullptr) {
-                    head = tail = restored;
-                } else {
-                    tail->next = restored;
-                    restored->prev = tail;
-                    tail = restored;
-                }
+                Task* restored = taskPool.create(lastAction->task);
+                linkBack(restored);
                 
-                cout << "✓ Отменено: удаление задачи #" << restored->id << endl;
+                message.assign("✓ Отменено: удаление задачи #").append(to_string(restored->id));
                 break;
             }
             
             case Action::COMPLETE: {
-                Task* current = head;
-                while (current != nullptr && current->id != lastAction->task->id) {
-                    current = current->next;
-                }
+                Task* current = findTask(lastAction->task.id);
                 
                 if (current != nullptr) {
                     current->completed = false;
-                    cout << "✓ Отменено: завершение задачи #" << current->id << endl;
+                    message.assign("✓ Отменено: завершение задачи #").append(to_string(current->id));
                 }
                 break;
             }
             
             case Action::UNCOMPLETE: {
-                Task* current = head;
-                while (current != nullptr && current->id != lastAction->task->id) {
-                    current = current->next;
-                }
+                Task* current = findTask(lastAction->task.id);
                 
                 if (current != nullptr) {
                     current->completed = true;
-                    cout << "✓ Отменено: снятие отметки выполнения задачи #" << current->id << endl;
+                    message.assign("✓ Отменено: снятие отметки выполнения задачи #").append(to_string(current->id));
                 }
                 break;
             }
         }
         
-        delete lastAction;
+        actionPool.destroy(lastAction);
+        return true;
     }
     
     void displayStatistics() {
@@ -366,9 +451,80 @@ public:
         cout << "  Low:    " << lowPriority << endl;
         
         cout << "\nДействий в истории: " << history.size() << endl;
+        cout << "Пулы: задачи " << taskPool.getLive() << " из " << taskPool.capacity()
+             << ", действия " << actionPool.getLive() << " из " << actionPool.capacity()
+             << ", строк в арене " << strings.getStrings() << " (" << strings.getBytes() << " байт)" << endl;
     }
     
 private:
+    // Индекс задач по ID - цепочки через поле bucketNext самих узлов, так что вставка
+    // не выделяет память. ID выдаются подряд, поэтому младшие биты годятся как хеш
+    void indexInsert(Task* task) {
+        if (indexed >= (int)buckets.size()) {
+            vector<Task*> old(buckets.size() * 2, nullptr);
+            old.swap(buckets);
+            for (Task* chain : old) {
+                while (chain != nullptr) {
+                    Task* next = chain->bucketNext;
+                    Task*& slot = buckets[chain->id & (buckets.size() - 1)];
+                    chain->bucketNext = slot;
+                    slot = chain;
+                    chain = next;
+                }
+            }
+        }
+        
+        Task*& slot = buckets[task->id & (buckets.size() - 1)];
+        task->bucketNext = slot;
+        slot = task;
+        indexed++;
+    }
+    
+    void indexErase(Task* task) {
+        Task** link = &buckets[task->id & (buckets.size() - 1)];
+        while (*link != task) link = &(*link)->bucketNext;
+        *link = task->bucketNext;
+        indexed--;
+    }
+    
+    void linkFront(Task* task) {
+        if (head == nullptr) {
+            head = tail = task;
+        } else {
+            task->next = head;
+            head->prev = task;
+            head = task;
+        }
+        indexInsert(task);
+    }
+    
+    void linkBack(Task* task) {
+        if (tail == nullptr) {
+            head = tail = task;
+        } else {
+            tail->next = task;
+            task->prev = tail;
+            tail = task;
+        }
+        indexInsert(task);
+    }
+    
+    void unlink(Task* current) {
+        if (current == head && current == tail) {
+            head = tail = nullptr;
+        } else if (current == head) {
+            head = head->next;
+            head->prev = nullptr;
+        } else if (current == tail) {
+            tail = tail->prev;
+            tail->next = nullptr;
+        } else {
+            current->prev->next = current->next;
+            current->next->prev = current->prev;
+        }
+        indexErase(current);
+    }
+    
     void displayTask(Task* task) {
         cout << "\n[" << task->id << "] ";
         cout << (task->completed ? "✓ " : "☐ ");
@@ -388,12 +544,78 @@ private:
         while (head != nullptr) {
             Task* temp = head;
             head = head->next;
-            delete temp;
+            taskPool.destroy(temp);
         }
         tail = nullptr;
+        fill(buckets.begin(), buckets.end(), nullptr);
+        indexed = 0;
     }
 };
 
+template <typename Func>
+double measureMs(Func action) {
+    auto start = chrono::steady_clock::now();
+    action();
+    auto finish = chrono::steady_clock::now();
+    return chrono::duration<double, milli>(finish - start).count();
+}
+
+// Операции по ID на больших списках: отметка, удаление и отмена всех действий в случайном
+// порядке ID, плюс поиск по индексу против прежнего прохода по списку. Второй проход идет
+// по тому же списку после полной отмены: пулы и арена уже заполнены, и malloc не нужен
+void runLookupBenchmark() {
+    cout << "\n╔════════════════════════════════════════╗" << endl;
+    cout << "║   БЕНЧМАРК: ОПЕРАЦИИ ПО ID            ║" << endl;
+    cout << "╚════════════════════════════════════════╝" << endl;
+    cout << "\n   задач  проход  добавить, мс  отметить, мс  удалить, мс  отменить, мс  слабов  "
+            "поиск: индекс / проход, нс" << endl;
+    
+    const string priorities[] = {"Low", "Medium", "High"};
+    mt19937 rng(1);
+    
+    for (int count : {1000, 10000, 100000}) {
+        ToDoList list;
+        vector<string> descriptions(count);
+        for (int i = 0; i < count; i++) descriptions[i] = "Задача " + to_string(i);
+        vector<int> order(count);
+        for (int i = 0; i < count; i++) order[i] = i + 1;
+        shuffle(order.begin(), order.end(), rng);
+        
+        for (int pass = 0; pass < 2; pass++) {
+            int base = pass * count;
+            double addMs = measureMs([&] {
+                for (int i = 0; i < count; i++) list.addTask(descriptions[i], priorities[i % 3], i % 2 == 0);
+            });
+            
+            const int lookups = 2000;
+            long long found = 0;
+            double indexMs = measureMs([&] {
+                for (int i = 0; i < lookups; i++) found += list.findTask(base + order[i % count]) != nullptr;
+            });
+            double linearMs = measureMs([&] {
+                for (int i = 0; i < lookups; i++) found += list.findTaskLinear(base + order[i % count]) != nullptr;
+            });
+            
+            double toggleMs = measureMs([&] {
+                for (int id : order) list.toggleById(base + id);
+            });
+            double removeMs = measureMs([&] {
+                for (int id : order) list.removeById(base + id);
+            });
+            string message;
+            double undoMs = measureMs([&] {
+                while (list.undoLast(message)) {}
+            });
+            
+            cout << setw(8) << count << setw(8) << pass + 1 << fixed << setprecision(2) << setw(14) << addMs
+                 << setw(14) << toggleMs << setw(13) << removeMs << setw(14) << undoMs << setw(8) << list.poolSlabs()
+                 << setw(14) << indexMs * 1e6 / lookups << " / " << linearMs * 1e6 / lookups
+                 << (found == 2 * lookups ? "" : " (!)") << endl;
+            cout << defaultfloat;
+        }
+    }
+}
+
 void displayMenu() {
     cout << "\n╔════════════════════════════════════════╗" << endl;
     cout << "║         TO-DO LIST                    ║" << endl;
@@ -407,6 +629,7 @@ void displayMenu() {
     cout << "7.  Показать выполненные задачи" << endl;
     cout << "8.  Отменить последнее действие (Undo)" << endl;
     cout << "9.  Статистика" << endl;
+    cout << "10. Бенчмарк операций по ID" << endl;
     cout << "0.  Выход" << endl;
     cout << "───────────────────────────────────────" << endl;
     cout << "Выберите действие: ";
@@ -450,6 +673,9 @@ int main() {
             case 9:
                 todoList.displayStatistics();
                 break;
+            case 10:
+                runLookupBenchmark();
+                break;
             case 0:
                 cout << "\nДо свидания!" << endl;
                 break;
@@ -3,6 +3,27 @@
 #include <sstream>
 #include <cmath>
 #include <cctype>
+#include <vector>
+#include <chrono>
+#include <iomanip>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <tuple>
+#include <cstring>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <cstdio>
+#include <charconv>
+#include <string_view>
+#include <random>
 
 using namespace std;
 
@@ -15,15 +36,15 @@ struct Node {
 };
 
 template <typename T>
-class Stack {
+class LinkedStack {
 private:
     Node<T>* top;
     int size;
     
 public:
-    Stack() : top(nullptr), size(0) {}
+    LinkedStack() : top(nullptr), size(0) {}
     
-    ~Stack() {
+    ~LinkedStack() {
         clear();
     }
     
@@ -54,147 +75,3186 @@ public:
         return top->data;
     }
     
-    bool isEmpty() const {
-        return top == nullptr;
+    bool isEmpty() const {
+        return top == nullptr;
+    }
+    
+    int getSize() const {
+        return size;
+    }
+    
+    void clear() {
+        while (!isEmpty()) {
+            pop();
+        }
+    }
+};
+
+// Стек на непрерывном массиве: первые InlineCapacity элементов хранятся внутри объекта,
+// при переполнении буфер удваивается в куче
+template <typename T, int InlineCapacity = 32>
+class Stack {
+private:
+    T inlineBuffer[InlineCapacity];
+    T* data;
+    int size;
+    int capacity;
+    
+    void grow() {
+        T* bigger = new T[capacity * 2];
+        for (int i = 0; i < size; i++) {
+            bigger[i] = data[i];
+        }
+        if (data != inlineBuffer) {
+            delete[] data;
+        }
+        data = bigger;
+        capacity *= 2;
+    }
+    
+public:
+    Stack() : data(inlineBuffer), size(0), capacity(InlineCapacity) {}
+    
+    Stack(const Stack&) = delete;
+    Stack& operator=(const Stack&) = delete;
+    
+    ~Stack() {
+        if (data != inlineBuffer) {
+            delete[] data;
+        }
+    }
+    
+    void push(T value) {
+        if (size == capacity) {
+            grow();
+        }
+        data[size++] = value;
+    }
+    
+    T pop() {
+        if (isEmpty()) {
+            throw runtime_error("Stack underflow");
+        }
+        return data[--size];
+    }
+    
+    T peek() const {
+        if (isEmpty()) {
+            throw runtime_error("Stack is empty");
+        }
+        return data[size - 1];
+    }
+    
+    bool isEmpty() const {
+        return size == 0;
+    }
+    
+    int getSize() const {
+        return size;
+    }
+    
+    void clear() {
+        size = 0;
+    }
+};
+
+// Псевдоним с одним параметром для шаблонных параметров template <typename> class: сам Stack
+// с параметром по умолчанию подходит туда только по правилам P0522, а их знают не все компиляторы
+template <typename T>
+using DefaultStack = Stack<T>;
+
+enum class OpCode : unsigned char {
+    PUSH_CONST,
+    PUSH_VAR,
+    ADD,
+    SUB,
+    MUL,
+    DIV,
+    POW,
+    SQRT,
+    LOG,
+    EXP,
+    MIN,
+    MAX,
+    LOAD_TEMP,
+    STORE_TEMP
+};
+
+// Встроенные функции: имя, код операции и число аргументов
+struct BuiltinFunction {
+    const char* name;
+    OpCode op;
+    int arity;
+};
+
+const BuiltinFunction FUNCTIONS[] = {
+    {"sqrt", OpCode::SQRT, 1},
+    {"log", OpCode::LOG, 1},
+    {"exp", OpCode::EXP, 1},
+    {"min", OpCode::MIN, 2},
+    {"max", OpCode::MAX, 2}
+};
+const int FUNCTION_COUNT = sizeof(FUNCTIONS) / sizeof(FUNCTIONS[0]);
+
+int findFunction(const string& name) {
+    for (int i = 0; i < FUNCTION_COUNT; i++) {
+        if (name == FUNCTIONS[i].name) return i;
+    }
+    return -1;
+}
+
+int arity(OpCode op) {
+    switch (op) {
+        case OpCode::PUSH_CONST:
+        case OpCode::PUSH_VAR:
+        case OpCode::LOAD_TEMP:
+        case OpCode::STORE_TEMP:
+            return 0;
+        case OpCode::SQRT:
+        case OpCode::LOG:
+        case OpCode::EXP:
+            return 1;
+        default:
+            return 2;
+    }
+}
+
+bool isCommutative(OpCode op) {
+    return op == OpCode::ADD || op == OpCode::MUL || op == OpCode::MIN || op == OpCode::MAX;
+}
+
+// Операция без проверки деления на ноль: вызывающий код проверяет делитель сам
+double applyOp(OpCode op, double a, double b) {
+    switch (op) {
+        case OpCode::ADD: return a + b;
+        case OpCode::SUB: return a - b;
+        case OpCode::MUL: return a * b;
+        case OpCode::DIV: return a / b;
+        case OpCode::POW: return pow(a, b);
+        case OpCode::SQRT: return sqrt(a);
+        case OpCode::LOG: return log(a);
+        case OpCode::EXP: return exp(a);
+        case OpCode::MIN: return fmin(a, b);
+        case OpCode::MAX: return fmax(a, b);
+        default: throw runtime_error("Unknown operator");
+    }
+}
+
+// Частные производные результата r = a op b по аргументам
+void partials(OpCode op, double a, double b, double r, double& da, double& db) {
+    switch (op) {
+        case OpCode::ADD: da = 1; db = 1; break;
+        case OpCode::SUB: da = 1; db = -1; break;
+        case OpCode::MUL: da = b; db = a; break;
+        case OpCode::DIV: da = 1 / b; db = -r / b; break;
+        case OpCode::POW:
+            da = b == 0 ? 0 : b * pow(a, b - 1);
+            db = a > 0 ? r * log(a) : 0;
+            break;
+        case OpCode::SQRT: da = 0.5 / r; db = 0; break;
+        case OpCode::LOG: da = 1 / a; db = 0; break;
+        case OpCode::EXP: da = r; db = 0; break;
+        case OpCode::MIN: da = a <= b; db = a > b; break;
+        case OpCode::MAX: da = a >= b; db = a < b; break;
+        default: da = db = 0;
+    }
+}
+
+struct Instruction {
+    OpCode op;
+    int operand;
+};
+
+// Скомпилированное выражение: команды стековой машины, пул констант и слоты переменных
+struct Program {
+    static const int MAX_STACK = 256;
+    static const int MAX_TEMPS = 256;
+    
+    vector<Instruction> code;
+    vector<double> constants;
+    vector<string> literals;
+    vector<string> variables;
+    int stackDepth = 0;
+    int tempCount = 0;
+    
+    int variableSlot(const string& name) const {
+        for (size_t i = 0; i < variables.size(); i++) {
+            if (variables[i] == name) return i;
+        }
+        return -1;
+    }
+};
+
+struct ExprNode {
+    OpCode op;
+    int operand;
+    int left;
+    int right;
+};
+
+// Граф выражения, восстановленный из байткода. Дети всегда идут раньше родителей;
+// общие подвыражения (LOAD_TEMP) становятся общими узлами
+struct ExpressionTree {
+    vector<ExprNode> nodes;
+    vector<double> constants;
+    vector<string> variables;
+    int rootIndex = -1;
+    
+    static ExpressionTree fromProgram(const Program& program) {
+        ExpressionTree tree;
+        tree.constants = program.constants;
+        tree.variables = program.variables;
+        vector<int> stack;
+        vector<int> temps(program.tempCount, -1);
+        
+        for (const Instruction& instruction : program.code) {
+            if (instruction.op == OpCode::STORE_TEMP) {
+                temps[instruction.operand] = stack.back();
+                continue;
+            }
+            if (instruction.op == OpCode::LOAD_TEMP) {
+                stack.push_back(temps[instruction.operand]);
+                continue;
+            }
+            
+            int left = -1, right = -1;
+            if (arity(instruction.op) == 2) {
+                right = stack.back();
+                stack.pop_back();
+            }
+            if (arity(instruction.op) >= 1) {
+                left = stack.back();
+                stack.pop_back();
+            }
+            
+            tree.nodes.push_back({instruction.op, instruction.operand, left, right});
+            stack.push_back(tree.nodes.size() - 1);
+        }
+        
+        tree.rootIndex = stack.back();
+        return tree;
+    }
+    
+    int root() const {
+        return rootIndex;
+    }
+};
+
+// Оптимизация: свертка констант и устранение общих подвыражений. Одинаковые узлы склеиваются
+// в DAG (аргументы коммутативных операций упорядочиваются), а узлы с несколькими родителями
+// вычисляются один раз и сохраняются во временные ячейки
+class ProgramOptimizer {
+private:
+    struct NodeHash {
+        size_t operator()(const tuple<int, int, int, int>& key) const {
+            uint64_t hash = 14695981039346656037ULL;
+            for (int part : {get<0>(key), get<1>(key), get<2>(key), get<3>(key)}) {
+                hash = (hash ^ (uint32_t)part) * 1099511628211ULL;
+            }
+            return hash;
+        }
+    };
+    
+    ExpressionTree dag;
+    unordered_map<tuple<int, int, int, int>, int, NodeHash> unique;
+    unordered_map<uint64_t, int> constantIndex;
+    vector<int> uses;
+    vector<int> temps;
+    vector<int> constantSlots;
+    Program result;
+    int depth = 0;
+    
+    int intern(OpCode op, int operand, int left, int right) {
+        auto key = make_tuple((int)op, operand, left, right);
+        auto it = unique.find(key);
+        if (it != unique.end()) return it->second;
+        
+        dag.nodes.push_back({op, operand, left, right});
+        unique[key] = dag.nodes.size() - 1;
+        return dag.nodes.size() - 1;
+    }
+    
+    int internConstant(double value) {
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        
+        auto it = constantIndex.find(bits);
+        if (it == constantIndex.end()) {
+            it = constantIndex.emplace(bits, dag.constants.size()).first;
+            dag.constants.push_back(value);
+        }
+        return intern(OpCode::PUSH_CONST, it->second, -1, -1);
+    }
+    
+    bool isConstant(int node) const {
+        return node >= 0 && dag.nodes[node].op == OpCode::PUSH_CONST;
+    }
+    
+    double constantValue(int node) const {
+        return dag.constants[dag.nodes[node].operand];
+    }
+    
+    void countUses(int node, vector<char>& visited) {
+        if (visited[node]) return;
+        visited[node] = 1;
+        
+        for (int child : {dag.nodes[node].left, dag.nodes[node].right}) {
+            if (child < 0) continue;
+            uses[child]++;
+            countUses(child, visited);
+        }
+    }
+    
+    void emit(Instruction instruction, int stackChange) {
+        result.code.push_back(instruction);
+        depth += stackChange;
+        result.stackDepth = max(result.stackDepth, depth);
+    }
+    
+    void generate(int node) {
+        const ExprNode& n = dag.nodes[node];
+        
+        if (temps[node] >= 0) {
+            emit({OpCode::LOAD_TEMP, temps[node]}, 1);
+            return;
+        }
+        if (n.op == OpCode::PUSH_VAR) {
+            emit({n.op, n.operand}, 1);
+            return;
+        }
+        if (n.op == OpCode::PUSH_CONST) {
+            // В пул попадают только константы, оставшиеся после свертки
+            if (constantSlots[n.operand] < 0) {
+                constantSlots[n.operand] = result.constants.size();
+                result.constants.push_back(dag.constants[n.operand]);
+            }
+            emit({n.op, constantSlots[n.operand]}, 1);
+            return;
+        }
+        
+        if (n.left >= 0) generate(n.left);
+        if (n.right >= 0) generate(n.right);
+        emit({n.op, 0}, 1 - arity(n.op));
+        
+        if (uses[node] > 1) {
+            temps[node] = result.tempCount++;
+            emit({OpCode::STORE_TEMP, temps[node]}, 0);
+        }
+    }
+    
+public:
+    Program optimize(const Program& program) {
+        ExpressionTree tree = ExpressionTree::fromProgram(program);
+        dag.variables = tree.variables;
+        vector<int> mapped(tree.nodes.size());
+        
+        for (size_t i = 0; i < tree.nodes.size(); i++) {
+            const ExprNode& node = tree.nodes[i];
+            
+            if (node.op == OpCode::PUSH_CONST) {
+                mapped[i] = internConstant(tree.constants[node.operand]);
+                continue;
+            }
+            if (node.op == OpCode::PUSH_VAR) {
+                mapped[i] = intern(OpCode::PUSH_VAR, node.operand, -1, -1);
+                continue;
+            }
+            
+            int left = mapped[node.left];
+            int right = node.right >= 0 ? mapped[node.right] : -1;
+            bool constantArguments = isConstant(left) && (right < 0 || isConstant(right));
+            
+            // Деление на константный ноль не сворачивается: ошибка должна возникнуть при вычислении
+            if (constantArguments && !(node.op == OpCode::DIV && constantValue(right) == 0)) {
+                double value = applyOp(node.op, constantValue(left), right >= 0 ? constantValue(right) : 0);
+                mapped[i] = internConstant(value);
+                continue;
+            }
+            
+            if (isCommutative(node.op) && left > right) {
+                swap(left, right);
+            }
+            mapped[i] = intern(node.op, 0, left, right);
+        }
+        
+        int root = mapped[tree.root()];
+        uses.assign(dag.nodes.size(), 0);
+        temps.assign(dag.nodes.size(), -1);
+        vector<char> visited(dag.nodes.size(), 0);
+        countUses(root, visited);
+        
+        constantSlots.assign(dag.constants.size(), -1);
+        result.variables = dag.variables;
+        generate(root);
+        
+        if (result.stackDepth > Program::MAX_STACK) {
+            throw runtime_error("Expression is too deep");
+        }
+        return result;
+    }
+};
+
+Program optimizeProgram(const Program& program) {
+    return ProgramOptimizer().optimize(program);
+}
+
+// Обратный режим автоматического дифференцирования. Граф программы строится один раз,
+// поэтому лента не записывается заново: прямой проход заполняет значения узлов,
+// обратный - сопряженные величины, и весь градиент получается за один проход
+class GradientProgram {
+private:
+    static const int BLOCK = 256;
+    
+    ExpressionTree tree;
+    vector<double> values;
+    vector<double> adjoints;
+    
+    void evaluateBlock(const double* const* columns, size_t offset, int count, double* nodeValues,
+                       double* nodeAdjoints, double* out, double* const* gradient) const {
+        for (size_t i = 0; i < tree.nodes.size(); i++) {
+            const ExprNode& node = tree.nodes[i];
+            double* r = nodeValues + i * BLOCK;
+            
+            if (node.op == OpCode::PUSH_CONST) {
+                fill(r, r + count, tree.constants[node.operand]);
+                continue;
+            }
+            if (node.op == OpCode::PUSH_VAR) {
+                const double* source = columns[node.operand] + offset;
+                copy(source, source + count, r);
+                continue;
+            }
+            
+            const double* a = nodeValues + (size_t)node.left * BLOCK;
+            const double* b = node.right >= 0 ? nodeValues + (size_t)node.right * BLOCK : a;
+            if (node.op == OpCode::DIV) {
+                for (int k = 0; k < count; k++) {
+                    if (b[k] == 0) throw runtime_error("Division by zero");
+                }
+            }
+            switch (node.op) {
+                case OpCode::ADD: for (int k = 0; k < count; k++) r[k] = a[k] + b[k]; break;
+                case OpCode::SUB: for (int k = 0; k < count; k++) r[k] = a[k] - b[k]; break;
+                case OpCode::MUL: for (int k = 0; k < count; k++) r[k] = a[k] * b[k]; break;
+                case OpCode::DIV: for (int k = 0; k < count; k++) r[k] = a[k] / b[k]; break;
+                case OpCode::SQRT: for (int k = 0; k < count; k++) r[k] = sqrt(a[k]); break;
+                default: for (int k = 0; k < count; k++) r[k] = applyOp(node.op, a[k], b[k]);
+            }
+        }
+        
+        int root = tree.root();
+        copy(nodeValues + (size_t)root * BLOCK, nodeValues + (size_t)root * BLOCK + count, out);
+        for (size_t v = 0; v < tree.variables.size(); v++) {
+            fill(gradient[v] + offset, gradient[v] + offset + count, 0.0);
+        }
+        fill(nodeAdjoints, nodeAdjoints + tree.nodes.size() * BLOCK, 0.0);
+        fill(nodeAdjoints + (size_t)root * BLOCK, nodeAdjoints + (size_t)root * BLOCK + count, 1.0);
+        
+        for (int i = root; i >= 0; i--) {
+            const ExprNode& node = tree.nodes[i];
+            const double* adjoint = nodeAdjoints + (size_t)i * BLOCK;
+            
+            if (node.op == OpCode::PUSH_CONST) continue;
+            if (node.op == OpCode::PUSH_VAR) {
+                double* target = gradient[node.operand] + offset;
+                for (int k = 0; k < count; k++) target[k] += adjoint[k];
+                continue;
+            }
+            
+            const double* r = nodeValues + (size_t)i * BLOCK;
+            const double* a = nodeValues + (size_t)node.left * BLOCK;
+            const double* b = node.right >= 0 ? nodeValues + (size_t)node.right * BLOCK : a;
+            double* leftAdjoint = nodeAdjoints + (size_t)node.left * BLOCK;
+            double* rightAdjoint = node.right >= 0 ? nodeAdjoints + (size_t)node.right * BLOCK : nullptr;
+            
+            // Частые операции без вызова partials, чтобы циклы векторизовались
+            switch (node.op) {
+                case OpCode::ADD:
+                    for (int k = 0; k < count; k++) {
+                        leftAdjoint[k] += adjoint[k];
+                        rightAdjoint[k] += adjoint[k];
+                    }
+                    break;
+                case OpCode::SUB:
+                    for (int k = 0; k < count; k++) {
+                        leftAdjoint[k] += adjoint[k];
+                        rightAdjoint[k] -= adjoint[k];
+                    }
+                    break;
+                case OpCode::MUL:
+                    for (int k = 0; k < count; k++) {
+                        leftAdjoint[k] += adjoint[k] * b[k];
+                        rightAdjoint[k] += adjoint[k] * a[k];
+                    }
+                    break;
+                case OpCode::DIV:
+                    for (int k = 0; k < count; k++) {
+                        leftAdjoint[k] += adjoint[k] / b[k];
+                        rightAdjoint[k] -= adjoint[k] * r[k] / b[k];
+                    }
+                    break;
+                case OpCode::SQRT:
+                    for (int k = 0; k < count; k++) leftAdjoint[k] += adjoint[k] * 0.5 / r[k];
+                    break;
+                case OpCode::EXP:
+                    for (int k = 0; k < count; k++) leftAdjoint[k] += adjoint[k] * r[k];
+                    break;
+                default:
+                    for (int k = 0; k < count; k++) {
+                        double da, db;
+                        partials(node.op, a[k], b[k], r[k], da, db);
+                        leftAdjoint[k] += adjoint[k] * da;
+                        if (rightAdjoint != nullptr) rightAdjoint[k] += adjoint[k] * db;
+                    }
+            }
+        }
+    }
+    
+public:
+    GradientProgram(const Program& program) : tree(ExpressionTree::fromProgram(program)) {
+        values.resize(tree.nodes.size());
+        adjoints.resize(tree.nodes.size());
+    }
+    
+    const vector<string>& variables() const {
+        return tree.variables;
+    }
+    
+    // Значение выражения; gradient[i] получает производную по variables()[i]
+    double evaluate(const double* variableValues, double* gradient) {
+        for (size_t i = 0; i < tree.nodes.size(); i++) {
+            const ExprNode& node = tree.nodes[i];
+            switch (node.op) {
+                case OpCode::PUSH_CONST:
+                    values[i] = tree.constants[node.operand];
+                    break;
+                case OpCode::PUSH_VAR:
+                    values[i] = variableValues[node.operand];
+                    break;
+                default: {
+                    double b = node.right >= 0 ? values[node.right] : 0;
+                    if (node.op == OpCode::DIV && b == 0) throw runtime_error("Division by zero");
+                    values[i] = applyOp(node.op, values[node.left], b);
+                }
+            }
+        }
+        
+        int root = tree.root();
+        fill(gradient, gradient + tree.variables.size(), 0.0);
+        fill(adjoints.begin(), adjoints.begin() + root, 0.0);
+        adjoints[root] = 1;
+        
+        for (int i = root; i >= 0; i--) {
+            const ExprNode& node = tree.nodes[i];
+            if (node.op == OpCode::PUSH_CONST) continue;
+            if (node.op == OpCode::PUSH_VAR) {
+                gradient[node.operand] += adjoints[i];
+                continue;
+            }
+            
+            double b = node.right >= 0 ? values[node.right] : 0;
+            double da, db;
+            partials(node.op, values[node.left], b, values[i], da, db);
+            adjoints[node.left] += adjoints[i] * da;
+            if (node.right >= 0) adjoints[node.right] += adjoints[i] * db;
+        }
+        
+        return values[root];
+    }
+    
+    // Столбцовый режим: значения и градиенты блоками по BLOCK строк, при необходимости в нескольких потоках
+    vector<double> evaluateColumns(const vector<const double*>& columns, size_t rows,
+                                   vector<vector<double>>& gradient, int threads = 0) const {
+        if (columns.size() != tree.variables.size()) {
+            throw runtime_error("Wrong number of columns");
+        }
+        
+        vector<double> results(rows);
+        gradient.assign(tree.variables.size(), vector<double>(rows));
+        vector<double*> gradientColumns;
+        for (vector<double>& column : gradient) gradientColumns.push_back(column.data());
+        
+        size_t blocks = (rows + BLOCK - 1) / BLOCK;
+        if (threads <= 0) {
+            threads = max(1u, thread::hardware_concurrency());
+        }
+        threads = (int)min<size_t>(threads, max<size_t>(1, blocks / 16));
+        
+        auto work = [&](size_t firstBlock, size_t lastBlock) {
+            vector<double> nodeValues(tree.nodes.size() * BLOCK);
+            vector<double> nodeAdjoints(tree.nodes.size() * BLOCK);
+            for (size_t block = firstBlock; block < lastBlock; block++) {
+                size_t offset = block * BLOCK;
+                int count = (int)min<size_t>(BLOCK, rows - offset);
+                evaluateBlock(columns.data(), offset, count, nodeValues.data(), nodeAdjoints.data(),
+                              &results[offset], gradientColumns.data());
+            }
+        };
+        
+        if (threads == 1) {
+            work(0, blocks);
+            return results;
+        }
+        
+        vector<thread> workers;
+        vector<exception_ptr> errors(threads);
+        size_t chunk = (blocks + threads - 1) / threads;
+        
+        for (int t = 0; t < threads; t++) {
+            size_t first = t * chunk;
+            size_t last = min(blocks, first + chunk);
+            if (first >= last) break;
+            
+            workers.emplace_back([&, t, first, last] {
+                try {
+                    work(first, last);
+                } catch (...) {
+                    errors[t] = current_exception();
+                }
+            });
+        }
+        
+        for (thread& worker : workers) {
+            worker.join();
+        }
+        for (const exception_ptr& error : errors) {
+            if (error) rethrow_exception(error);
+        }
+        
+        return results;
+    }
+};
+
+// Целое произвольной длины: знак и модуль в системе счисления 2^32, младшие разряды первыми
+class BigInteger {
+private:
+    typedef vector<uint32_t> Digits;
+    
+    static const size_t KARATSUBA_THRESHOLD = 32;
+    
+    bool negative = false;
+    Digits digits;
+    
+    static void trim(Digits& a) {
+        while (!a.empty() && a.back() == 0) a.pop_back();
+    }
+    
+    static int compareMagnitude(const Digits& a, const Digits& b) {
+        if (a.size() != b.size()) return a.size() < b.size() ? -1 : 1;
+        for (size_t i = a.size(); i-- > 0;) {
+            if (a[i] != b[i]) return a[i] < b[i] ? -1 : 1;
+        }
+        return 0;
+    }
+    
+    // a += b * 2^(32 * shift)
+    static void addShifted(Digits& a, const Digits& b, size_t shift) {
+        if (a.size() < b.size() + shift) a.resize(b.size() + shift, 0);
+        
+        uint64_t carry = 0;
+        for (size_t i = 0; i < b.size(); i++) {
+            uint64_t sum = (uint64_t)a[i + shift] + b[i] + carry;
+            a[i + shift] = (uint32_t)sum;
+            carry = sum >> 32;
+        }
+        for (size_t i = b.size() + shift; carry != 0; i++) {
+            if (i == a.size()) a.push_back(0);
+            uint64_t sum = (uint64_t)a[i] + carry;
+            a[i] = (uint32_t)sum;
+            carry = sum >> 32;
+        }
+    }
+    
+    // a -= b при |a| >= |b|
+    static void subtractMagnitude(Digits& a, const Digits& b) {
+        int64_t borrow = 0;
+        for (size_t i = 0; i < a.size() && (i < b.size() || borrow != 0); i++) {
+            int64_t difference = (int64_t)a[i] - (i < b.size() ? b[i] : 0) - borrow;
+            borrow = difference < 0;
+            a[i] = (uint32_t)(difference + (borrow << 32));
+        }
+        trim(a);
+    }
+    
+    static Digits multiplyBasic(const Digits& a, const Digits& b) {
+        if (a.empty() || b.empty()) return {};
+        
+        Digits result(a.size() + b.size(), 0);
+        for (size_t i = 0; i < a.size(); i++) {
+            uint64_t carry = 0;
+            for (size_t j = 0; j < b.size(); j++) {
+                uint64_t current = (uint64_t)a[i] * b[j] + result[i + j] + carry;
+                result[i + j] = (uint32_t)current;
+                carry = current >> 32;
+            }
+            result[i + b.size()] = (uint32_t)carry;
+        }
+        trim(result);
+        return result;
+    }
+    
+    static Digits slice(const Digits& a, size_t from, size_t to) {
+        from = min(from, a.size());
+        to = min(to, a.size());
+        Digits result(a.begin() + from, a.begin() + to);
+        trim(result);
+        return result;
+    }
+    
+    // Карацуба: три умножения половинной длины вместо четырех
+    static Digits multiplyKaratsuba(const Digits& a, const Digits& b) {
+        if (min(a.size(), b.size()) < KARATSUBA_THRESHOLD) {
+            return multiplyBasic(a, b);
+        }
+        
+        size_t half = max(a.size(), b.size()) / 2;
+        Digits a0 = slice(a, 0, half), a1 = slice(a, half, a.size());
+        Digits b0 = slice(b, 0, half), b1 = slice(b, half, b.size());
+        
+        Digits low = multiplyKaratsuba(a0, b0);
+        Digits high = multiplyKaratsuba(a1, b1);
+        addShifted(a0, a1, 0);
+        addShifted(b0, b1, 0);
+        Digits middle = multiplyKaratsuba(a0, b0);
+        subtractMagnitude(middle, low);
+        subtractMagnitude(middle, high);
+        
+        Digits result = low;
+        addShifted(result, middle, half);
+        addShifted(result, high, 2 * half);
+        trim(result);
+        return result;
+    }
+    
+    // Делит на цифру на месте и возвращает остаток
+    static uint32_t divideSmall(Digits& a, uint32_t divisor) {
+        uint64_t remainder = 0;
+        for (size_t i = a.size(); i-- > 0;) {
+            uint64_t current = (remainder << 32) | a[i];
+            a[i] = (uint32_t)(current / divisor);
+            remainder = current % divisor;
+        }
+        trim(a);
+        return (uint32_t)remainder;
+    }
+    
+    static void multiplySmallAdd(Digits& a, uint32_t factor, uint32_t addend) {
+        uint64_t carry = addend;
+        for (uint32_t& digit : a) {
+            uint64_t current = (uint64_t)digit * factor + carry;
+            digit = (uint32_t)current;
+            carry = current >> 32;
+        }
+        if (carry != 0) a.push_back((uint32_t)carry);
+    }
+    
+    static Digits shiftLeftBits(const Digits& a, int bits) {
+        Digits result(a.size() + 1, 0);
+        for (size_t i = 0; i < a.size(); i++) {
+            result[i] |= a[i] << bits;
+            result[i + 1] = bits == 0 ? 0 : a[i] >> (32 - bits);
+        }
+        return result;
+    }
+    
+    // Деление столбиком по Кнуту (алгоритм D)
+    static void divideMagnitude(const Digits& a, const Digits& b, Digits& quotient, Digits& remainder) {
+        if (compareMagnitude(a, b) < 0) {
+            quotient.clear();
+            remainder = a;
+            return;
+        }
+        if (b.size() == 1) {
+            quotient = a;
+            remainder.assign(1, divideSmall(quotient, b[0]));
+            trim(remainder);
+            return;
+        }
+        
+        int shift = 0;
+        while ((b.back() << shift & 0x80000000u) == 0) shift++;
+        Digits u = shiftLeftBits(a, shift);
+        Digits v = shiftLeftBits(b, shift);
+        v.pop_back();
+        
+        size_t n = v.size(), m = a.size() - n;
+        quotient.assign(m + 1, 0);
+        const uint64_t base = (uint64_t)1 << 32;
+        
+        for (size_t j = m + 1; j-- > 0;) {
+            uint64_t numerator = ((uint64_t)u[j + n] << 32) | u[j + n - 1];
+            uint64_t estimate = numerator / v[n - 1];
+            uint64_t rest = numerator % v[n - 1];
+            
+            while (estimate >= base || estimate * v[n - 2] > ((rest << 32) | u[j + n - 2])) {
+                estimate--;
+                rest += v[n - 1];
+                if (rest >= base) break;
+            }
+            
+            int64_t borrow = 0;
+            uint64_t carry = 0;
+            for (size_t i = 0; i < n; i++) {
+                uint64_t product = estimate * v[i] + carry;
+                carry = product >> 32;
+                int64_t difference = (int64_t)u[i + j] - (uint32_t)product - borrow;
+                borrow = difference < 0;
+                u[i + j] = (uint32_t)(difference + (borrow << 32));
+            }
+            int64_t difference = (int64_t)u[j + n] - (int64_t)carry - borrow;
+            u[j + n] = (uint32_t)difference;
+            
+            // Оценка оказалась на единицу больше: возвращаем делитель
+            if (difference < 0) {
+                estimate--;
+                carry = 0;
+                for (size_t i = 0; i < n; i++) {
+                    uint64_t sum = (uint64_t)u[i + j] + v[i] + carry;
+                    u[i + j] = (uint32_t)sum;
+                    carry = sum >> 32;
+                }
+                u[j + n] += (uint32_t)carry;
+            }
+            quotient[j] = (uint32_t)estimate;
+        }
+        
+        trim(quotient);
+        remainder.assign(n, 0);
+        for (size_t i = 0; i < n; i++) {
+            remainder[i] = shift == 0 ? u[i] : (u[i] >> shift) | (u[i + 1] << (32 - shift));
+        }
+        trim(remainder);
+    }
+    
+    static BigInteger fromDigits(Digits digits, bool negative) {
+        BigInteger result;
+        result.digits = move(digits);
+        result.negative = negative && !result.digits.empty();
+        return result;
+    }
+    
+public:
+    BigInteger(long long value = 0) {
+        negative = value < 0;
+        uint64_t magnitude = negative ? 0 - (uint64_t)value : (uint64_t)value;
+        while (magnitude != 0) {
+            digits.push_back((uint32_t)magnitude);
+            magnitude >>= 32;
+        }
+    }
+    
+    static BigInteger parse(string_view text) {
+        bool sign = !text.empty() && text[0] == '-';
+        if (sign) text.remove_prefix(1);
+        if (text.empty()) throw runtime_error("Invalid number");
+        
+        Digits digits;
+        for (char c : text) {
+            if (!isdigit((unsigned char)c)) throw runtime_error("Invalid number: " + string(text));
+            multiplySmallAdd(digits, 10, c - '0');
+        }
+        trim(digits);
+        return fromDigits(move(digits), sign);
+    }
+    
+    static BigInteger power10(int exponent) {
+        BigInteger result(1);
+        for (; exponent >= 9; exponent -= 9) multiplySmallAdd(result.digits, 1000000000, 0);
+        for (; exponent > 0; exponent--) multiplySmallAdd(result.digits, 10, 0);
+        return result;
+    }
+    
+    bool isZero() const {
+        return digits.empty();
+    }
+    
+    bool isNegative() const {
+        return negative;
+    }
+    
+    size_t limbs() const {
+        return digits.size();
+    }
+    
+    BigInteger operator-() const {
+        return fromDigits(digits, !negative);
+    }
+    
+    friend BigInteger operator+(const BigInteger& a, const BigInteger& b) {
+        if (a.negative == b.negative) {
+            Digits sum = a.digits;
+            addShifted(sum, b.digits, 0);
+            return fromDigits(move(sum), a.negative);
+        }
+        if (compareMagnitude(a.digits, b.digits) >= 0) {
+            Digits difference = a.digits;
+            subtractMagnitude(difference, b.digits);
+            return fromDigits(move(difference), a.negative);
+        }
+        Digits difference = b.digits;
+        subtractMagnitude(difference, a.digits);
+        return fromDigits(move(difference), b.negative);
+    }
+    
+    friend BigInteger operator-(const BigInteger& a, const BigInteger& b) {
+        return a + (-b);
+    }
+    
+    friend BigInteger operator*(const BigInteger& a, const BigInteger& b) {
+        return fromDigits(multiplyKaratsuba(a.digits, b.digits), a.negative != b.negative);
+    }
+    
+    // Умножение столбиком без Карацубы, для сравнения в бенчмарке
+    static BigInteger multiplySchoolbook(const BigInteger& a, const BigInteger& b) {
+        return fromDigits(multiplyBasic(a.digits, b.digits), a.negative != b.negative);
+    }
+    
+    // Деление с отбрасыванием дробной части; остаток имеет знак делимого
+    static void divide(const BigInteger& a, const BigInteger& b, BigInteger& quotient, BigInteger& remainder) {
+        if (b.isZero()) throw runtime_error("Division by zero");
+        
+        Digits q, r;
+        divideMagnitude(a.digits, b.digits, q, r);
+        quotient = fromDigits(move(q), a.negative != b.negative);
+        remainder = fromDigits(move(r), a.negative);
+    }
+    
+    friend BigInteger operator/(const BigInteger& a, const BigInteger& b) {
+        BigInteger quotient, remainder;
+        divide(a, b, quotient, remainder);
+        return quotient;
+    }
+    
+    friend BigInteger operator%(const BigInteger& a, const BigInteger& b) {
+        BigInteger quotient, remainder;
+        divide(a, b, quotient, remainder);
+        return remainder;
+    }
+    
+    friend int compare(const BigInteger& a, const BigInteger& b) {
+        if (a.negative != b.negative) return a.negative ? -1 : 1;
+        int magnitude = compareMagnitude(a.digits, b.digits);
+        return a.negative ? -magnitude : magnitude;
+    }
+    
+    friend bool operator==(const BigInteger& a, const BigInteger& b) {
+        return a.negative == b.negative && a.digits == b.digits;
+    }
+    
+    friend bool operator<(const BigInteger& a, const BigInteger& b) {
+        return compare(a, b) < 0;
+    }
+    
+    static BigInteger gcd(BigInteger a, BigInteger b) {
+        a.negative = b.negative = false;
+        while (!b.isZero()) {
+            BigInteger rest = a % b;
+            a = move(b);
+            b = move(rest);
+        }
+        return a;
+    }
+    
+    static BigInteger power(BigInteger base, unsigned long long exponent) {
+        BigInteger result(1);
+        while (exponent > 0) {
+            if (exponent & 1) result = result * base;
+            exponent >>= 1;
+            if (exponent > 0) base = base * base;
+        }
+        return result;
+    }
+    
+    double toDouble() const {
+        double result = 0;
+        for (size_t i = digits.size(); i-- > 0;) result = result * 4294967296.0 + digits[i];
+        return negative ? -result : result;
+    }
+    
+    string toString() const {
+        if (digits.empty()) return "0";
+        
+        Digits rest = digits;
+        vector<uint32_t> groups;
+        while (!rest.empty()) groups.push_back(divideSmall(rest, 1000000000));
+        
+        string result = negative ? "-" : "";
+        result += to_string(groups.back());
+        for (size_t i = groups.size() - 1; i-- > 0;) {
+            string group = to_string(groups[i]);
+            result += string(9 - group.size(), '0') + group;
+        }
+        return result;
+    }
+};
+
+// Разбор десятичной записи "123.45e-6" в целую мантиссу и десятичный порядок
+void parseDecimal(string_view text, BigInteger& mantissa, int& exponent) {
+    const int MAX_EXPONENT = 4096;
+    size_t end = text.find_first_of("eE");
+    string_view number = text.substr(0, end);
+    exponent = 0;
+    
+    if (end != string_view::npos) {
+        string_view power = text.substr(end + 1);
+        if (!power.empty() && power[0] == '+') power.remove_prefix(1);
+        from_chars_result result = from_chars(power.data(), power.data() + power.size(), exponent);
+        if (result.ec != errc() || result.ptr != power.data() + power.size() || abs(exponent) > MAX_EXPONENT) {
+            throw runtime_error("Invalid number: " + string(text));
+        }
+    }
+    
+    string digits;
+    size_t point = number.find('.');
+    if (point != string_view::npos) {
+        digits.append(number.substr(0, point));
+        digits.append(number.substr(point + 1));
+        exponent -= number.size() - point - 1;
+    } else {
+        digits.append(number);
+    }
+    if (digits.empty() || digits == "-") {
+        throw runtime_error("Invalid number: " + string(text));
+    }
+    mantissa = BigInteger::parse(digits);
+}
+
+// Точная рациональная дробь: знаменатель положителен, дробь несократима
+class Rational {
+private:
+    BigInteger numerator;
+    BigInteger denominator;
+    
+    void normalize() {
+        if (denominator.isZero()) throw runtime_error("Division by zero");
+        if (denominator.isNegative()) {
+            numerator = -numerator;
+            denominator = -denominator;
+        }
+        
+        BigInteger common = BigInteger::gcd(numerator, denominator);
+        if (!(common == BigInteger(1)) && !common.isZero()) {
+            numerator = numerator / common;
+            denominator = denominator / common;
+        }
+    }
+    
+public:
+    Rational(long long value = 0) : numerator(value), denominator(1) {}
+    
+    Rational(BigInteger top, BigInteger bottom) : numerator(move(top)), denominator(move(bottom)) {
+        normalize();
+    }
+    
+    static Rational parse(string_view text) {
+        BigInteger mantissa;
+        int exponent;
+        parseDecimal(text, mantissa, exponent);
+        
+        if (exponent >= 0) return Rational(mantissa * BigInteger::power10(exponent), 1);
+        return Rational(mantissa, BigInteger::power10(-exponent));
+    }
+    
+    bool isZero() const {
+        return numerator.isZero();
+    }
+    
+    bool isInteger() const {
+        return denominator == BigInteger(1);
+    }
+    
+    friend Rational operator+(const Rational& a, const Rational& b) {
+        if (a.denominator == b.denominator) return Rational(a.numerator + b.numerator, a.denominator);
+        return Rational(a.numerator * b.denominator + b.numerator * a.denominator, a.denominator * b.denominator);
+    }
+    
+    friend Rational operator-(const Rational& a, const Rational& b) {
+        return a + Rational(-b.numerator, b.denominator);
+    }
+    
+    friend Rational operator*(const Rational& a, const Rational& b) {
+        return Rational(a.numerator * b.numerator, a.denominator * b.denominator);
+    }
+    
+    friend Rational operator/(const Rational& a, const Rational& b) {
+        if (b.isZero()) throw runtime_error("Division by zero");
+        return Rational(a.numerator * b.denominator, a.denominator * b.numerator);
+    }
+    
+    friend bool operator<(const Rational& a, const Rational& b) {
+        return a.numerator * b.denominator < b.numerator * a.denominator;
+    }
+    
+    // Точная степень возможна только для целого показателя
+    static Rational power(const Rational& base, const Rational& exponent) {
+        const long long MAX_EXPONENT = 1 << 16;
+        if (!exponent.isInteger() || abs(exponent.numerator.toDouble()) > MAX_EXPONENT) {
+            throw runtime_error("Exact power needs a small integer exponent");
+        }
+        
+        long long n = (long long)exponent.numerator.toDouble();
+        Rational result(BigInteger::power(base.numerator, llabs(n)), BigInteger::power(base.denominator, llabs(n)));
+        return n >= 0 ? result : Rational(1) / result;
+    }
+    
+    double toDouble() const {
+        return numerator.toDouble() / denominator.toDouble();
+    }
+    
+    string toString() const {
+        if (isInteger()) return numerator.toString();
+        return numerator.toString() + "/" + denominator.toString();
+    }
+};
+
+// Десятичное число с фиксированной точкой: целое число единиц 10^-SCALE,
+// умножение и деление округляют половину от нуля
+class Decimal {
+private:
+    static const int SCALE = 18;
+    
+    BigInteger units;
+    
+    static const BigInteger& unit() {
+        static const BigInteger value = BigInteger::power10(SCALE);
+        return value;
+    }
+    
+    static BigInteger divideRounded(const BigInteger& a, const BigInteger& b) {
+        BigInteger quotient, remainder;
+        BigInteger::divide(a, b, quotient, remainder);
+        
+        BigInteger twice = remainder + remainder;
+        if (twice.isNegative()) twice = -twice;
+        BigInteger divisor = b.isNegative() ? -b : b;
+        if (!(twice < divisor)) {
+            quotient = quotient + BigInteger(a.isNegative() != b.isNegative() ? -1 : 1);
+        }
+        return quotient;
+    }
+    
+    static Decimal fromUnits(BigInteger units) {
+        Decimal result;
+        result.units = move(units);
+        return result;
+    }
+    
+public:
+    Decimal(long long value = 0) : units(BigInteger(value) * unit()) {}
+    
+    static Decimal parse(string_view text) {
+        BigInteger mantissa;
+        int exponent;
+        parseDecimal(text, mantissa, exponent);
+        
+        exponent += SCALE;
+        if (exponent >= 0) return fromUnits(mantissa * BigInteger::power10(exponent));
+        return fromUnits(divideRounded(mantissa, BigInteger::power10(-exponent)));
+    }
+    
+    bool isZero() const {
+        return units.isZero();
+    }
+    
+    friend Decimal operator+(const Decimal& a, const Decimal& b) {
+        return fromUnits(a.units + b.units);
+    }
+    
+    friend Decimal operator-(const Decimal& a, const Decimal& b) {
+        return fromUnits(a.units - b.units);
+    }
+    
+    friend Decimal operator*(const Decimal& a, const Decimal& b) {
+        return fromUnits(divideRounded(a.units * b.units, unit()));
+    }
+    
+    friend Decimal operator/(const Decimal& a, const Decimal& b) {
+        if (b.isZero()) throw runtime_error("Division by zero");
+        return fromUnits(divideRounded(a.units * unit(), b.units));
+    }
+    
+    friend bool operator<(const Decimal& a, const Decimal& b) {
+        return a.units < b.units;
+    }
+    
+    static Decimal power(const Decimal& base, const Decimal& exponent) {
+        const long long MAX_EXPONENT = 1 << 16;
+        BigInteger whole, fraction;
+        BigInteger::divide(exponent.units, unit(), whole, fraction);
+        if (!fraction.isZero() || abs(whole.toDouble()) > MAX_EXPONENT) {
+            throw runtime_error("Exact power needs a small integer exponent");
+        }
+        
+        long long n = (long long)whole.toDouble();
+        Decimal result(1), factor = base;
+        for (long long rest = llabs(n); rest > 0; rest >>= 1) {
+            if (rest & 1) result = result * factor;
+            if (rest > 1) factor = factor * factor;
+        }
+        return n >= 0 ? result : Decimal(1) / result;
+    }
+    
+    double toDouble() const {
+        return units.toDouble() / unit().toDouble();
+    }
+    
+    string toString() const {
+        string digits = (units.isNegative() ? -units : units).toString();
+        if (digits.size() <= (size_t)SCALE) digits.insert(0, SCALE + 1 - digits.size(), '0');
+        
+        string whole = digits.substr(0, digits.size() - SCALE);
+        string fraction = digits.substr(digits.size() - SCALE);
+        fraction.erase(fraction.find_last_not_of('0') + 1);
+        
+        string sign = units.isNegative() ? "-" : "";
+        return fraction.empty() ? sign + whole : sign + whole + "." + fraction;
+    }
+};
+
+// Политика чисел для обобщенного интерпретатора: разбор литерала, степень и функции
+template <typename Number>
+struct NumericPolicy {
+    static const bool exact = true;
+    
+    static Number parse(string_view text) {
+        return Number::parse(text);
+    }
+    
+    static Number apply(OpCode op, const Number& a, const Number& b) {
+        switch (op) {
+            case OpCode::ADD: return a + b;
+            case OpCode::SUB: return a - b;
+            case OpCode::MUL: return a * b;
+            case OpCode::DIV: return a / b;
+            case OpCode::POW: return Number::power(a, b);
+            case OpCode::MIN: return b < a ? b : a;
+            case OpCode::MAX: return a < b ? b : a;
+            default: throw runtime_error("Function is not supported in exact mode");
+        }
+    }
+};
+
+template <>
+struct NumericPolicy<double> {
+    static const bool exact = false;
+    
+    static double parse(string_view text) {
+        double value;
+        const char* last = text.data() + text.size();
+        from_chars_result result = from_chars(text.data(), last, value);
+        if (result.ec != errc() || result.ptr != last) {
+            throw runtime_error("Invalid number: " + string(text));
+        }
+        return value;
+    }
+    
+    static double apply(OpCode op, double a, double b) {
+        if (op == OpCode::DIV && b == 0) throw runtime_error("Division by zero");
+        return applyOp(op, a, b);
+    }
+};
+
+// Дуальное число для прямого режима дифференцирования: значение и производная по выбранному направлению
+struct Dual {
+    double value;
+    double derivative;
+    
+    Dual(double v = 0, double d = 0) : value(v), derivative(d) {}
+};
+
+template <>
+struct NumericPolicy<Dual> {
+    static const bool exact = false;
+    
+    static Dual parse(string_view text) {
+        return Dual(NumericPolicy<double>::parse(text));
+    }
+    
+    static Dual apply(OpCode op, const Dual& a, const Dual& b) {
+        double value = NumericPolicy<double>::apply(op, a.value, b.value);
+        double da, db;
+        partials(op, a.value, b.value, value, da, db);
+        double derivative = da * a.derivative;
+        if (arity(op) == 2) derivative += db * b.derivative;
+        return Dual(value, derivative);
+    }
+};
+
+// Байткод, вычисляемый в произвольной арифметике. Для точных типов константы берутся из исходных
+// литералов, поэтому программа должна быть скомпилирована без оптимизации: свертка идет в double
+template <typename Number>
+class NumericProgram {
+private:
+    Program program;
+    vector<Number> constants;
+    vector<Number> stack;
+    vector<Number> temps;
+    
+public:
+    NumericProgram(const Program& source) : program(source) {
+        bool hasLiterals = program.literals.size() == program.constants.size();
+        if (NumericPolicy<Number>::exact && !hasLiterals) {
+            throw runtime_error("Program has folded constants: compile it without optimization");
+        }
+        for (size_t i = 0; i < program.constants.size(); i++) {
+            constants.push_back(hasLiterals ? NumericPolicy<Number>::parse(program.literals[i])
+                                            : Number(program.constants[i]));
+        }
+        stack.resize(program.stackDepth);
+        temps.resize(program.tempCount);
+    }
+    
+    const vector<string>& variables() const {
+        return program.variables;
+    }
+    
+    // Значения переменных передаются в порядке variables()
+    Number evaluate(const Number* values) {
+        int top = -1;
+        
+        for (const Instruction& instruction : program.code) {
+            switch (instruction.op) {
+                case OpCode::PUSH_CONST:
+                    stack[++top] = constants[instruction.operand];
+                    break;
+                case OpCode::PUSH_VAR:
+                    stack[++top] = values[instruction.operand];
+                    break;
+                case OpCode::LOAD_TEMP:
+                    stack[++top] = temps[instruction.operand];
+                    break;
+                case OpCode::STORE_TEMP:
+                    temps[instruction.operand] = stack[top];
+                    break;
+                default:
+                    if (arity(instruction.op) == 1) {
+                        stack[top] = NumericPolicy<Number>::apply(instruction.op, stack[top], stack[top]);
+                    } else {
+                        stack[top - 1] = NumericPolicy<Number>::apply(instruction.op, stack[top - 1], stack[top]);
+                        top--;
+                    }
+            }
+        }
+        
+        return stack[0];
+    }
+};
+
+enum class TokenType : unsigned char {
+    NUMBER,
+    NAME,
+    OPERATOR,
+    FUNCTION
+};
+
+// Лексема ссылается на исходную строку (или на статические имена операторов и функций)
+// и действительна, пока жива эта строка
+struct Token {
+    TokenType type;
+    char op;
+    double value;
+    string_view text;
+};
+
+const char OPERATOR_TEXT[] = "+-*/^";
+
+class RPNCalculator {
+private:
+    vector<Token> scratchTokens;
+    
+    bool isOperator(char c) {
+        return c == '+' || c == '-' || c == '*' || c == '/' || c == '^';
+    }
+    
+    int getPrecedence(char op) {
+        if (op == '+' || op == '-') return 1;
+        if (op == '*' || op == '/') return 2;
+        if (op == '^') return 3;
+        return 0;
+    }
+    
+    bool isRightAssociative(char op) {
+        return op == '^';
+    }
+    
+    bool isFunctionCode(char c) {
+        return c >= 1 && c <= FUNCTION_COUNT;
+    }
+    
+    double applyOperator(double a, double b, char op) {
+        switch (op) {
+            case '+': return a + b;
+            case '-': return a - b;
+            case '*': return a * b;
+            case '/':
+                if (b == 0) throw runtime_error("Division by zero");
+                return a / b;
+            case '^': return pow(a, b);
+            default: throw runtime_error("Unknown operator");
+        }
+    }
+    
+    static bool parseNumber(string_view text, double& value) {
+        const char* last = text.data() + text.size();
+        from_chars_result result = from_chars(text.data(), last, value);
+        return result.ec == errc() && result.ptr == last;
+    }
+    
+    static Token operatorToken(char op) {
+        const char* position = strchr(OPERATOR_TEXT, op);
+        return {TokenType::OPERATOR, op, 0, string_view(position, 1)};
+    }
+    
+    static Token functionToken(int function) {
+        return {TokenType::FUNCTION, (char)function, 0, FUNCTIONS[function].name};
+    }
+    
+public:
+    
+    // Разбор постфиксной записи: лексемы разделяются пробелами, строки не копируются
+    void tokenizeRPN(string_view expression, vector<Token>& tokens) {
+        tokens.clear();
+        size_t i = 0;
+        
+        while (i < expression.size()) {
+            if (isspace((unsigned char)expression[i])) {
+                i++;
+                continue;
+            }
+            
+            size_t start = i;
+            while (i < expression.size() && !isspace((unsigned char)expression[i])) i++;
+            string_view text = expression.substr(start, i - start);
+            Token token = {TokenType::NUMBER, 0, 0, text};
+            char first = text[0];
+            
+            if (isdigit((unsigned char)first) || first == '.' || (text.size() > 1 && first == '-')) {
+                if (!parseNumber(text, token.value)) {
+                    throw runtime_error("Invalid token: " + string(text));
+                }
+            }
+            else if (text.size() == 1 && isOperator(first)) {
+                token.type = TokenType::OPERATOR;
+                token.op = first;
+            }
+            else if (findFunction(string(text)) >= 0) {
+                token = functionToken(findFunction(string(text)));
+            }
+            else if (isalpha((unsigned char)first) || first == '_') {
+                token.type = TokenType::NAME;
+            }
+            else {
+                throw runtime_error("Invalid token: " + string(text));
+            }
+            
+            tokens.push_back(token);
+        }
+    }
+    
+    // Сортировочная станция: лексемы сразу складываются в выходной вектор в постфиксном порядке
+    template <template <typename> class StackType = DefaultStack>
+    void infixToTokens(string_view expression, vector<Token>& output) {
+        StackType<char> operators;
+        output.clear();
+        
+        for (size_t i = 0; i < expression.length(); i++) {
+            char c = expression[i];
+            
+            if (isspace((unsigned char)c)) continue;
+            
+            if (isdigit((unsigned char)c) || c == '.') {
+                size_t start = i;
+                while (i + 1 < expression.length() && 
+                       (isdigit((unsigned char)expression[i + 1]) || expression[i + 1] == '.')) {
+                    i++;
+                }
+                
+                Token token = {TokenType::NUMBER, 0, 0, expression.substr(start, i + 1 - start)};
+                if (!parseNumber(token.text, token.value)) {
+                    throw runtime_error("Invalid number: " + string(token.text));
+                }
+                output.push_back(token);
+            }
+            else if (isalpha((unsigned char)c) || c == '_') {
+                size_t start = i;
+                while (i + 1 < expression.length() && 
+                       (isalnum((unsigned char)expression[i + 1]) || expression[i + 1] == '_')) {
+                    i++;
+                }
+                string_view name = expression.substr(start, i + 1 - start);
+                
+                size_t next = i + 1;
+                while (next < expression.length() && isspace((unsigned char)expression[next])) next++;
+                bool call = next < expression.length() && expression[next] == '(';
+                int function = findFunction(string(name));
+                
+                if (call && function < 0) {
+                    throw runtime_error("Unknown function: " + string(name));
+                }
+                if (!call && function >= 0) {
+                    throw runtime_error("Function requires arguments: " + string(name));
+                }
+                
+                if (call) {
+                    // На стеке операторов функция хранится кодом 1..FUNCTION_COUNT
+                    operators.push((char)(function + 1));
+                } else {
+                    output.push_back({TokenType::NAME, 0, 0, name});
+                }
+            }
+            else if (c == '(') {
+                operators.push(c);
+            }
+            else if (c == ',') {
+                while (!operators.isEmpty() && operators.peek() != '(') {
+                    output.push_back(operatorToken(operators.pop()));
+                }
+                
+                if (operators.isEmpty()) {
+                    throw runtime_error("Misplaced comma");
+                }
+            }
+            else if (c == ')') {
+                while (!operators.isEmpty() && operators.peek() != '(') {
+                    output.push_back(operatorToken(operators.pop()));
+                }
+                
+                if (operators.isEmpty()) {
+                    throw runtime_error("Mismatched parentheses");
+                }
+                
+                operators.pop();
+                
+                if (!operators.isEmpty() && isFunctionCode(operators.peek())) {
+                    output.push_back(functionToken(operators.pop() - 1));
+                }
+            }
+            else if (isOperator(c)) {
+                while (!operators.isEmpty() && operators.peek() != '(' &&
+                       (getPrecedence(operators.peek()) > getPrecedence(c) ||
+                        (getPrecedence(operators.peek()) == getPrecedence(c) && 
+                         !isRightAssociative(c)))) {
+                    output.push_back(operatorToken(operators.pop()));
+                }
+                operators.push(c);
+            }
+            else {
+                throw runtime_error(string("Invalid character: ") + c);
+            }
+        }
+        
+        while (!operators.isEmpty()) {
+            char op = operators.pop();
+            if (op == '(' || op == ')' || isFunctionCode(op)) {
+                throw runtime_error("Mismatched parentheses");
+            }
+            output.push_back(operatorToken(op));
+        }
+    }
+    
+    template <template <typename> class StackType = DefaultStack>
+    double evaluateTokens(const vector<Token>& tokens) {
+        StackType<double> stack;
+        
+        for (const Token& token : tokens) {
+            switch (token.type) {
+                case TokenType::NUMBER:
+                    stack.push(token.value);
+                    break;
+                case TokenType::OPERATOR: {
+                    if (stack.getSize() < 2) {
+                        throw runtime_error("Invalid expression: not enough operands");
+                    }
+                    
+                    double b = stack.pop();
+                    double a = stack.pop();
+                    stack.push(applyOperator(a, b, token.op));
+                    break;
+                }
+                case TokenType::FUNCTION: {
+                    const BuiltinFunction& function = FUNCTIONS[(int)token.op];
+                    if (stack.getSize() < function.arity) {
+                        throw runtime_error("Invalid expression: not enough operands");
+                    }
+                    
+                    double b = function.arity == 2 ? stack.pop() : 0;
+                    double a = stack.pop();
+                    stack.push(applyOp(function.op, a, b));
+                    break;
+                }
+                case TokenType::NAME:
+                    throw runtime_error("Invalid token: " + string(token.text));
+            }
+        }
+        
+        if (stack.getSize() != 1) {
+            throw runtime_error("Invalid expression: too many operands");
+        }
+        
+        return stack.pop();
+    }
+    
+    template <template <typename> class StackType = DefaultStack>
+    double evaluateRPN(const string& expression) {
+        tokenizeRPN(expression, scratchTokens);
+        return evaluateTokens<StackType>(scratchTokens);
+    }
+    
+    template <template <typename> class StackType = DefaultStack>
+    string infixToRPN(const string& expression) {
+        infixToTokens<StackType>(expression, scratchTokens);
+        
+        string output;
+        for (const Token& token : scratchTokens) {
+            output.append(token.text);
+            output += ' ';
+        }
+        return output;
+    }
+    
+    template <template <typename> class StackType = DefaultStack>
+    double evaluateInfix(const string& expression) {
+        infixToTokens<StackType>(expression, scratchTokens);
+        return evaluateTokens<StackType>(scratchTokens);
+    }
+    
+    // Разбор выполняется один раз; дальше выражение вычисляется без строк и выделений памяти
+    Program compileTokens(const vector<Token>& tokens) {
+        Program program;
+        int depth = 0;
+        // Пул констант по битам значения; одинаковое значение с разной записью - разные ячейки,
+        // чтобы точные режимы разбирали исходный текст
+        unordered_multimap<uint64_t, int> constantIndex;
+        
+        for (const Token& token : tokens) {
+            if (token.type == TokenType::NUMBER) {
+                uint64_t bits;
+                memcpy(&bits, &token.value, sizeof(bits));
+                int index = -1;
+                auto range = constantIndex.equal_range(bits);
+                for (auto it = range.first; it != range.second && index < 0; ++it) {
+                    if (program.literals[it->second] == token.text) index = it->second;
+                }
+                if (index < 0) {
+                    index = program.constants.size();
+                    constantIndex.emplace(bits, index);
+                    program.constants.push_back(token.value);
+                    program.literals.emplace_back(token.text);
+                }
+                program.code.push_back({OpCode::PUSH_CONST, index});
+                depth++;
+            }
+            else if (token.type == TokenType::FUNCTION) {
+                const BuiltinFunction& function = FUNCTIONS[(int)token.op];
+                if (depth < function.arity) {
+                    throw runtime_error("Invalid expression: not enough operands");
+                }
+                program.code.push_back({function.op, 0});
+                depth -= function.arity - 1;
+            }
+            else if (token.type == TokenType::NAME) {
+                string name(token.text);
+                int slot = program.variableSlot(name);
+                if (slot < 0) {
+                    slot = program.variables.size();
+                    program.variables.push_back(name);
+                }
+                program.code.push_back({OpCode::PUSH_VAR, slot});
+                depth++;
+            }
+            else {
+                if (depth < 2) {
+                    throw runtime_error("Invalid expression: not enough operands");
+                }
+                program.code.push_back({toOpCode(token.op), 0});
+                depth--;
+            }
+            
+            program.stackDepth = max(program.stackDepth, depth);
+            if (program.stackDepth > Program::MAX_STACK) {
+                throw runtime_error("Expression is too deep");
+            }
+        }
+        
+        if (depth != 1) {
+            throw runtime_error("Invalid expression: too many operands");
+        }
+        
+        return program;
+    }
+    
+    Program compileRPN(const string& expression) {
+        tokenizeRPN(expression, scratchTokens);
+        return compileTokens(scratchTokens);
+    }
+    
+    Program compile(const string& expression, bool optimize = true) {
+        infixToTokens(expression, scratchTokens);
+        Program program = compileTokens(scratchTokens);
+        return optimize ? optimizeProgram(program) : program;
+    }
+    
+    // Прежний разбор через stringstream; оставлен для сравнения в бенчмарке разбора
+    double evaluateRPNStream(const string& expression) {
+        Stack<double> stack;
+        stringstream ss(expression);
+        string token;
+        
+        while (ss >> token) {
+            if (isdigit(token[0]) || (token.length() > 1 && token[0] == '-')) {
+                stack.push(stod(token));
+            }
+            else if (token.length() == 1 && isOperator(token[0])) {
+                if (stack.getSize() < 2) {
+                    throw runtime_error("Invalid expression: not enough operands");
+                }
+                
+                double b = stack.pop();
+                double a = stack.pop();
+                double result = applyOperator(a, b, token[0]);
+                stack.push(result);
+            }
+            else if (findFunction(token) >= 0) {
+                const BuiltinFunction& function = FUNCTIONS[findFunction(token)];
+                if (stack.getSize() < function.arity) {
+                    throw runtime_error("Invalid expression: not enough operands");
+                }
+                
+                double b = function.arity == 2 ? stack.pop() : 0;
+                double a = stack.pop();
+                stack.push(applyOp(function.op, a, b));
+            }
+            else {
+                throw runtime_error("Invalid token: " + token);
+            }
+        }
+        
+        if (stack.getSize() != 1) {
+            throw runtime_error("Invalid expression: too many operands");
+        }
+        
+        return stack.pop();
+    }
+    
+    string infixToRPNStream(const string& expression) {
+        Stack<char> operators;
+        stringstream output;
+        
+        for (size_t i = 0; i < expression.length(); i++) {
+            char c = expression[i];
+            
+            if (isspace(c)) continue;
+            
+            if (isdigit(c) || c == '.') {
+                output << c;
+                
+                while (i + 1 < expression.length() && 
+                       (isdigit(expression[i + 1]) || expression[i + 1] == '.')) {
+                    output << expression[++i];
+                }
+                output << ' ';
+            }
+            else if (isalpha(c) || c == '_') {
+                string name(1, c);
+                
+                while (i + 1 < expression.length() && 
+                       (isalnum(expression[i + 1]) || expression[i + 1] == '_')) {
+                    name += expression[++i];
+                }
+                
+                size_t next = i + 1;
+                while (next < expression.length() && isspace(expression[next])) next++;
+                bool call = next < expression.length() && expression[next] == '(';
+                int function = findFunction(name);
+                
+                if (call && function < 0) {
+                    throw runtime_error("Unknown function: " + name);
+                }
+                if (!call && function >= 0) {
+                    throw runtime_error("Function requires arguments: " + name);
+                }
+                
+                if (call) {
+                    // На стеке операторов функция хранится кодом 1..FUNCTION_COUNT
+                    operators.push((char)(function + 1));
+                } else {
+                    output << name << ' ';
+                }
+            }
+            else if (c == '(') {
+                operators.push(c);
+            }
+            else if (c == ',') {
+                while (!operators.isEmpty() && operators.peek() != '(') {
+                    output << operators.pop() << ' ';
+                }
+                
+                if (operators.isEmpty()) {
+                    throw runtime_error("Misplaced comma");
+                }
+            }
+            else if (c == ')') {
+                while (!operators.isEmpty() && operators.peek() != '(') {
+                    output << operators.pop() << ' ';
+                }
+                
+                if (operators.isEmpty()) {
+                    throw runtime_error("Mismatched parentheses");
+                }
+                
+                operators.pop();
+                
+                if (!operators.isEmpty() && isFunctionCode(operators.peek())) {
+                    output << FUNCTIONS[operators.pop() - 1].name << ' ';
+                }
+            }
+            else if (isOperator(c)) {
+                while (!operators.isEmpty() && operators.peek() != '(' &&
+                       (getPrecedence(operators.peek()) > getPrecedence(c) ||
+                        (getPrecedence(operators.peek()) == getPrecedence(c) && 
+                         !isRightAssociative(c)))) {
+                    output << operators.pop() << ' ';
+                }
+                operators.push(c);
+            }
+            else {
+                throw runtime_error(string("Invalid character: ") + c);
+            }
+        }
+        
+        while (!operators.isEmpty()) {
+            char op = operators.pop();
+            if (op == '(' || op == ')') {
+                throw runtime_error("Mismatched parentheses");
+            }
+            output << op << ' ';
+        }
+        
+        return output.str();
+    }
+    
+    double evaluateInfixStream(const string& expression) {
+        return evaluateRPNStream(infixToRPNStream(expression));
+    }
+    
+    // Значения переменных передаются в порядке program.variables
+    // Обычно временных ячеек немного и они лежат на стеке; большим формулам они выделяются в куче
+    double execute(const Program& program, const double* variables) const {
+        if (program.tempCount > Program::MAX_TEMPS) {
+            vector<double> temps(program.tempCount);
+            return execute(program, variables, temps.data());
+        }
+        double temps[Program::MAX_TEMPS];
+        return execute(program, variables, temps);
+    }
+    
+    double execute(const Program& program, const double* variables, double* temps) const {
+        double stack[Program::MAX_STACK];
+        int top = -1;
+        
+        for (const Instruction& instruction : program.code) {
+            switch (instruction.op) {
+                case OpCode::PUSH_CONST:
+                    stack[++top] = program.constants[instruction.operand];
+                    break;
+                case OpCode::PUSH_VAR:
+                    stack[++top] = variables[instruction.operand];
+                    break;
+                case OpCode::ADD:
+                    stack[top - 1] += stack[top];
+                    top--;
+                    break;
+                case OpCode::SUB:
+                    stack[top - 1] -= stack[top];
+                    top--;
+                    break;
+                case OpCode::MUL:
+                    stack[top - 1] *= stack[top];
+                    top--;
+                    break;
+                case OpCode::DIV:
+                    if (stack[top] == 0) throw runtime_error("Division by zero");
+                    stack[top - 1] /= stack[top];
+                    top--;
+                    break;
+                case OpCode::POW:
+                    stack[top - 1] = pow(stack[top - 1], stack[top]);
+                    top--;
+                    break;
+                case OpCode::SQRT:
+                    stack[top] = sqrt(stack[top]);
+                    break;
+                case OpCode::LOG:
+                    stack[top] = log(stack[top]);
+                    break;
+                case OpCode::EXP:
+                    stack[top] = exp(stack[top]);
+                    break;
+                case OpCode::MIN:
+                    stack[top - 1] = fmin(stack[top - 1], stack[top]);
+                    top--;
+                    break;
+                case OpCode::MAX:
+                    stack[top - 1] = fmax(stack[top - 1], stack[top]);
+                    top--;
+                    break;
+                case OpCode::LOAD_TEMP:
+                    stack[++top] = temps[instruction.operand];
+                    break;
+                case OpCode::STORE_TEMP:
+                    temps[instruction.operand] = stack[top];
+                    break;
+            }
+        }
+        
+        return stack[0];
+    }
+    
+    double execute(const Program& program, const vector<double>& variables) const {
+        if (variables.size() != program.variables.size()) {
+            throw runtime_error("Wrong number of variable values");
+        }
+        return execute(program, variables.data());
+    }
+    
+    static const int COLUMN_BLOCK = 256;
+    
+    // Столбцовый режим: каждая команда применяется сразу к блоку строк, циклы по блоку векторизуются.
+    // columns[i] - значения переменной program.variables[i] для всех строк
+    vector<double> executeColumns(const Program& program, const vector<const double*>& columns,
+                                  size_t rows, int threads = 0) const {
+        if (columns.size() != program.variables.size()) {
+            throw runtime_error("Wrong number of columns");
+        }
+        
+        vector<double> results(rows);
+        size_t blocks = (rows + COLUMN_BLOCK - 1) / COLUMN_BLOCK;
+        
+        if (threads <= 0) {
+            threads = max(1u, thread::hardware_concurrency());
+        }
+        threads = (int)min<size_t>(threads, max<size_t>(1, blocks / 16));
+        
+        auto work = [&](size_t firstBlock, size_t lastBlock) {
+            vector<double> scratch((size_t)(program.stackDepth + program.tempCount) * COLUMN_BLOCK);
+            for (size_t block = firstBlock; block < lastBlock; block++) {
+                size_t offset = block * COLUMN_BLOCK;
+                int count = (int)min<size_t>(COLUMN_BLOCK, rows - offset);
+                executeBlock(program, columns.data(), offset, count, scratch.data(), &results[offset]);
+            }
+        };
+        
+        if (threads == 1) {
+            work(0, blocks);
+            return results;
+        }
+        
+        vector<thread> workers;
+        vector<exception_ptr> errors(threads);
+        size_t chunk = (blocks + threads - 1) / threads;
+        
+        for (int t = 0; t < threads; t++) {
+            size_t first = t * chunk;
+            size_t last = min(blocks, first + chunk);
+            if (first >= last) break;
+            
+            workers.emplace_back([&, t, first, last] {
+                try {
+                    work(first, last);
+                } catch (...) {
+                    errors[t] = current_exception();
+                }
+            });
+        }
+        
+        for (thread& worker : workers) {
+            worker.join();
+        }
+        for (const exception_ptr& error : errors) {
+            if (error) rethrow_exception(error);
+        }
+        
+        return results;
+    }
+    
+    vector<double> executeColumns(const Program& program, const vector<vector<double>>& columns,
+                                  int threads = 0) const {
+        vector<const double*> pointers;
+        size_t rows = columns.empty() ? 1 : columns[0].size();
+        
+        for (const vector<double>& column : columns) {
+            if (column.size() != rows) {
+                throw runtime_error("Columns have different lengths");
+            }
+            pointers.push_back(column.data());
+        }
+        
+        return executeColumns(program, pointers, rows, threads);
+    }
+    
+    // Столбцовое вычисление вместе с градиентом: gradient[i] - производные по program.variables[i]
+    vector<double> executeColumnsGradient(const Program& program, const vector<vector<double>>& columns,
+                                          vector<vector<double>>& gradient, int threads = 0) const {
+        size_t rows = columns.empty() ? 0 : columns[0].size();
+        vector<const double*> pointers;
+        for (const vector<double>& column : columns) {
+            if (column.size() != rows) {
+                throw runtime_error("Columns have different lengths");
+            }
+            pointers.push_back(column.data());
+        }
+        
+        return GradientProgram(program).evaluateColumns(pointers, rows, gradient, threads);
+    }
+    
+private:
+    void executeBlock(const Program& program, const double* const* columns, size_t offset, int count,
+                      double* scratch, double* out) const {
+        int top = -1;
+        
+        for (const Instruction& instruction : program.code) {
+            if (instruction.op == OpCode::PUSH_CONST) {
+                double* target = scratch + (size_t)(++top) * COLUMN_BLOCK;
+                fill(target, target + count, program.constants[instruction.operand]);
+                continue;
+            }
+            if (instruction.op == OpCode::PUSH_VAR) {
+                double* target = scratch + (size_t)(++top) * COLUMN_BLOCK;
+                const double* source = columns[instruction.operand] + offset;
+                copy(source, source + count, target);
+                continue;
+            }
+            
+            // Временные ячейки лежат в scratch после области стека
+            double* temps = scratch + (size_t)program.stackDepth * COLUMN_BLOCK;
+            if (instruction.op == OpCode::LOAD_TEMP) {
+                double* target = scratch + (size_t)(++top) * COLUMN_BLOCK;
+                const double* source = temps + (size_t)instruction.operand * COLUMN_BLOCK;
+                copy(source, source + count, target);
+                continue;
+            }
+            if (instruction.op == OpCode::STORE_TEMP) {
+                const double* source = scratch + (size_t)top * COLUMN_BLOCK;
+                copy(source, source + count, temps + (size_t)instruction.operand * COLUMN_BLOCK);
+                continue;
+            }
+            
+            if (arity(instruction.op) == 1) {
+                double* a = scratch + (size_t)top * COLUMN_BLOCK;
+                switch (instruction.op) {
+                    case OpCode::SQRT:
+                        for (int k = 0; k < count; k++) a[k] = sqrt(a[k]);
+                        break;
+                    case OpCode::LOG:
+                        for (int k = 0; k < count; k++) a[k] = log(a[k]);
+                        break;
+                    case OpCode::EXP:
+                        for (int k = 0; k < count; k++) a[k] = exp(a[k]);
+                        break;
+                    default:
+                        break;
+                }
+                continue;
+            }
+            
+            double* a = scratch + (size_t)(top - 1) * COLUMN_BLOCK;
+            const double* b = a + COLUMN_BLOCK;
+            top--;
+            
+            switch (instruction.op) {
+                case OpCode::ADD:
+                    for (int k = 0; k < count; k++) a[k] += b[k];
+                    break;
+                case OpCode::SUB:
+                    for (int k = 0; k < count; k++) a[k] -= b[k];
+                    break;
+                case OpCode::MUL:
+                    for (int k = 0; k < count; k++) a[k] *= b[k];
+                    break;
+                case OpCode::DIV: {
+                    bool zero = false;
+                    for (int k = 0; k < count; k++) {
+                        zero |= b[k] == 0;
+                        a[k] /= b[k];
+                    }
+                    if (zero) throw runtime_error("Division by zero");
+                    break;
+                }
+                case OpCode::POW: {
+                    // Одинаковый по блоку показатель 2 или 3 (обычно константа) считается умножением
+                    bool uniform = true;
+                    for (int k = 1; k < count; k++) uniform &= b[k] == b[0];
+                    
+                    if (uniform && b[0] == 2) {
+                        for (int k = 0; k < count; k++) a[k] *= a[k];
+                    } else if (uniform && b[0] == 3) {
+                        for (int k = 0; k < count; k++) a[k] *= a[k] * a[k];
+                    } else {
+                        for (int k = 0; k < count; k++) a[k] = pow(a[k], b[k]);
+                    }
+                    break;
+                }
+                case OpCode::MIN:
+                    for (int k = 0; k < count; k++) a[k] = fmin(a[k], b[k]);
+                    break;
+                case OpCode::MAX:
+                    for (int k = 0; k < count; k++) a[k] = fmax(a[k], b[k]);
+                    break;
+                default:
+                    break;
+            }
+        }
+        
+        copy(scratch, scratch + count, out);
+    }
+    
+    static OpCode toOpCode(char op) {
+        switch (op) {
+            case '+': return OpCode::ADD;
+            case '-': return OpCode::SUB;
+            case '*': return OpCode::MUL;
+            case '/': return OpCode::DIV;
+            case '^': return OpCode::POW;
+            default: throw runtime_error("Unknown operator");
+        }
+    }
+};
+
+// Специализированное выражение: дерево замыканий, каждое со своей функцией под конкретный вид узла.
+// Константные поддеревья сворачиваются, а ^ с малым целым показателем заменяется умножениями
+class SpecializedExpression {
+private:
+    struct Closure;
+    typedef double (*EvalFunction)(const Closure&, const double*);
+    
+    struct Closure {
+        EvalFunction eval;
+        const Closure* left;
+        const Closure* right;
+        double constant;
+        int slot;
+    };
+    
+    vector<Closure> closures;
+    const Closure* root;
+    
+    static double evalConst(const Closure& c, const double*) { return c.constant; }
+    static double evalVar(const Closure& c, const double* vars) { return vars[c.slot]; }
+    
+    static double evalAdd(const Closure& c, const double* vars) {
+        return c.left->eval(*c.left, vars) + c.right->eval(*c.right, vars);
+    }
+    static double evalSub(const Closure& c, const double* vars) {
+        return c.left->eval(*c.left, vars) - c.right->eval(*c.right, vars);
+    }
+    static double evalMul(const Closure& c, const double* vars) {
+        return c.left->eval(*c.left, vars) * c.right->eval(*c.right, vars);
+    }
+    static double evalDiv(const Closure& c, const double* vars) {
+        double a = c.left->eval(*c.left, vars);
+        double b = c.right->eval(*c.right, vars);
+        if (b == 0) throw runtime_error("Division by zero");
+        return a / b;
+    }
+    static double evalPow(const Closure& c, const double* vars) {
+        return pow(c.left->eval(*c.left, vars), c.right->eval(*c.right, vars));
+    }
+    
+    // Частые сочетания "переменная и константа" без лишних косвенных вызовов
+    static double evalAddVarConst(const Closure& c, const double* vars) { return vars[c.slot] + c.constant; }
+    static double evalMulVarConst(const Closure& c, const double* vars) { return vars[c.slot] * c.constant; }
+    static double evalSubVarConst(const Closure& c, const double* vars) { return vars[c.slot] - c.constant; }
+    static double evalMulVarVar(const Closure& c, const double* vars) {
+        return vars[c.slot] * vars[(int)c.constant];
+    }
+    
+    static double evalSquare(const Closure& c, const double* vars) {
+        double a = c.left->eval(*c.left, vars);
+        return a * a;
+    }
+    static double evalCube(const Closure& c, const double* vars) {
+        double a = c.left->eval(*c.left, vars);
+        return a * a * a;
+    }
+    static double evalPowInt(const Closure& c, const double* vars) {
+        double base = c.left->eval(*c.left, vars);
+        int n = c.slot;
+        bool negative = n < 0;
+        if (negative) n = -n;
+        
+        double result = 1;
+        while (n > 0) {
+            if (n & 1) result *= base;
+            base *= base;
+            n >>= 1;
+        }
+        return negative ? 1 / result : result;
+    }
+    
+    static double evalFunction1(const Closure& c, const double* vars) {
+        return applyOp((OpCode)c.slot, c.left->eval(*c.left, vars), 0);
+    }
+    static double evalMin(const Closure& c, const double* vars) {
+        return fmin(c.left->eval(*c.left, vars), c.right->eval(*c.right, vars));
+    }
+    static double evalMax(const Closure& c, const double* vars) {
+        return fmax(c.left->eval(*c.left, vars), c.right->eval(*c.right, vars));
+    }
+    
+    const Closure* make(const Closure& closure) {
+        closures.push_back(closure);
+        return &closures.back();
+    }
+    
+    // Общий узел графа получает одно общее замыкание
+    const Closure* build(const ExpressionTree& tree, int index, vector<const Closure*>& built) {
+        if (built[index] == nullptr) {
+            built[index] = buildNode(tree, index, built);
+        }
+        return built[index];
+    }
+    
+    const Closure* buildNode(const ExpressionTree& tree, int index, vector<const Closure*>& built) {
+        const ExprNode& node = tree.nodes[index];
+        
+        if (node.op == OpCode::PUSH_CONST) {
+            return make({evalConst, nullptr, nullptr, tree.constants[node.operand], 0});
+        }
+        if (node.op == OpCode::PUSH_VAR) {
+            return make({evalVar, nullptr, nullptr, 0, node.operand});
+        }
+        
+        const Closure* left = build(tree, node.left, built);
+        
+        if (arity(node.op) == 1) {
+            if (left->eval == evalConst) {
+                return make({evalConst, nullptr, nullptr, applyOp(node.op, left->constant, 0), 0});
+            }
+            return make({evalFunction1, left, nullptr, 0, (int)node.op});
+        }
+        
+        const Closure* right = build(tree, node.right, built);
+        bool leftConst = left->eval == evalConst;
+        bool rightConst = right->eval == evalConst;
+        bool leftVar = left->eval == evalVar;
+        bool rightVar = right->eval == evalVar;
+        
+        // Деление на константный ноль не сворачивается: ошибка должна возникнуть при вычислении
+        if (leftConst && rightConst && !(node.op == OpCode::DIV && right->constant == 0)) {
+            return make({evalConst, nullptr, nullptr, applyOp(node.op, left->constant, right->constant), 0});
+        }
+        
+        switch (node.op) {
+            case OpCode::MIN:
+                return make({evalMin, left, right, 0, 0});
+            case OpCode::MAX:
+                return make({evalMax, left, right, 0, 0});
+            case OpCode::ADD:
+                if (leftVar && rightConst) return make({evalAddVarConst, nullptr, nullptr, right->constant, left->slot});
+                if (leftConst && rightVar) return make({evalAddVarConst, nullptr, nullptr, left->constant, right->slot});
+                return make({evalAdd, left, right, 0, 0});
+            case OpCode::SUB:
+                if (leftVar && rightConst) return make({evalSubVarConst, nullptr, nullptr, right->constant, left->slot});
+                return make({evalSub, left, right, 0, 0});
+            case OpCode::MUL:
+                if (leftVar && rightConst) return make({evalMulVarConst, nullptr, nullptr, right->constant, left->slot});
+                if (leftConst && rightVar) return make({evalMulVarConst, nullptr, nullptr, left->constant, right->slot});
+                if (leftVar && rightVar) return make({evalMulVarVar, nullptr, nullptr, (double)right->slot, left->slot});
+                return make({evalMul, left, right, 0, 0});
+            case OpCode::DIV:
+                return make({evalDiv, left, right, 0, 0});
+            case OpCode::POW:
+                if (rightConst && right->constant == 1) return left;
+                if (rightConst && right->constant == 2) return make({evalSquare, left, nullptr, 0, 0});
+                if (rightConst && right->constant == 3) return make({evalCube, left, nullptr, 0, 0});
+                if (rightConst && right->constant == (int)right->constant && abs(right->constant) <= 64) {
+                    return make({evalPowInt, left, nullptr, 0, (int)right->constant});
+                }
+                return make({evalPow, left, right, 0, 0});
+            default:
+                throw runtime_error("Unknown operator");
+        }
+    }
+    
+public:
+    vector<string> variables;
+    
+    SpecializedExpression(const Program& program) {
+        ExpressionTree tree = ExpressionTree::fromProgram(program);
+        variables = tree.variables;
+        closures.reserve(tree.nodes.size());
+        vector<const Closure*> built(tree.nodes.size(), nullptr);
+        root = build(tree, tree.root(), built);
+    }
+    
+    SpecializedExpression(const SpecializedExpression&) = delete;
+    SpecializedExpression& operator=(const SpecializedExpression&) = delete;
+    
+    double operator()(const double* values) const {
+        return root->eval(*root, values);
+    }
+    
+    // Число замыканий, достижимых из корня (листья, поглощенные слиянием, не считаются)
+    int size() const {
+        vector<char> visited(closures.size(), 0);
+        return countReachable(root, visited);
+    }
+    
+private:
+    int countReachable(const Closure* closure, vector<char>& visited) const {
+        if (closure == nullptr) return 0;
+        
+        char& seen = visited[closure - closures.data()];
+        if (seen) return 0;
+        seen = 1;
+        return 1 + countReachable(closure->left, visited) + countReachable(closure->right, visited);
+    }
+};
+
+// Ограниченный LRU-кэш скомпилированных выражений. Ключ - нормализованное дерево выражения:
+// пробелы не влияют, аргументы + и * упорядочены, числа приведены к одной записи.
+// Для выражений без переменных дополнительно хранится готовый результат
+class ExpressionCache {
+private:
+    static const size_t MAX_ALIASES = 8;
+    
+    struct Entry {
+        string key;
+        Program program;
+        bool hasValue;
+        double value;
+        vector<string> aliases;
+    };
+    
+    RPNCalculator& calc;
+    size_t capacity;
+    list<Entry> entries;
+    unordered_map<string, list<Entry>::iterator> byKey;
+    unordered_map<string, list<Entry>::iterator> byText;
+    vector<Token> tokens;
+    long long hitCount = 0;
+    long long missCount = 0;
+    
+    // Быстрый ключ по тексту: пробелы удаляются, кроме единственного между двумя
+    // частями одного операнда ("1 2" не должно совпасть с "12")
+    static string compactText(const string& expression) {
+        string text;
+        text.reserve(expression.size());
+        bool pendingSpace = false;
+        
+        for (char c : expression) {
+            if (isspace((unsigned char)c)) {
+                pendingSpace = true;
+                continue;
+            }
+            bool word = isalnum((unsigned char)c) || c == '.' || c == '_';
+            if (pendingSpace && word && !text.empty() &&
+                (isalnum((unsigned char)text.back()) || text.back() == '.' || text.back() == '_')) {
+                text += ' ';
+            }
+            text += c;
+            pendingSpace = false;
+        }
+        return text;
+    }
+    
+    // Только + и *: у min и max от +0 и -0 результат зависит от порядка аргументов
+    static bool isCommutativeToken(const Token& token) {
+        return token.type == TokenType::OPERATOR && (token.op == '+' || token.op == '*');
+    }
+    
+    // Аргументы + и * упорядочиваются - a + b и b + a в double равны точно.
+    // Цепочки не раскрываются: (a + b) + c и a + (b + c) округляются по-разному и остаются
+    // разными ключами. В конец ключа идет порядок переменных: по нему программа раскладывает
+    // значения по слотам, и выражения с разным порядком не должны делить одну программу
+    string normalize(const vector<Token>& tokens) {
+        vector<string> stack;
+        vector<string> variables;
+        
+        for (const Token& token : tokens) {
+            int count = token.type == TokenType::OPERATOR ? 2 :
+                        token.type == TokenType::FUNCTION ? FUNCTIONS[(int)token.op].arity : 0;
+            
+            if (count == 0) {
+                if (token.type == TokenType::NUMBER) {
+                    char number[32];
+                    stack.emplace_back(number, to_chars(number, number + sizeof(number), token.value).ptr);
+                } else {
+                    stack.emplace_back(token.text);
+                    if (token.type == TokenType::NAME &&
+                        find(variables.begin(), variables.end(), token.text) == variables.end()) {
+                        variables.emplace_back(token.text);
+                    }
+                }
+                continue;
+            }
+            
+            if ((int)stack.size() < count) {
+                throw runtime_error("Invalid expression: not enough operands");
+            }
+            
+            size_t first = stack.size() - count;
+            if (isCommutativeToken(token) && stack[first + 1] < stack[first]) {
+                swap(stack[first], stack[first + 1]);
+            }
+            
+            string node = "(";
+            node.append(token.text);
+            for (size_t i = first; i < stack.size(); i++) {
+                node += ' ';
+                node += stack[i];
+            }
+            node += ')';
+            stack.resize(first);
+            stack.push_back(move(node));
+        }
+        
+        if (stack.size() != 1) {
+            throw runtime_error("Invalid expression: too many operands");
+        }
+        
+        string key = stack[0] + " |";
+        for (const string& name : variables) key += " " + name;
+        return key;
+    }
+    
+    void touch(list<Entry>::iterator entry) {
+        entries.splice(entries.begin(), entries, entry);
+    }
+    
+    void evictLast() {
+        Entry& last = entries.back();
+        for (const string& alias : last.aliases) byText.erase(alias);
+        byKey.erase(last.key);
+        entries.pop_back();
+    }
+    
+    list<Entry>::iterator lookup(const string& expression) {
+        string text = compactText(expression);
+        
+        auto known = byText.find(text);
+        if (known != byText.end()) {
+            hitCount++;
+            touch(known->second);
+            return known->second;
+        }
+        
+        calc.infixToTokens(expression, tokens);
+        string key = normalize(tokens);
+        auto found = byKey.find(key);
+        if (found != byKey.end()) {
+            hitCount++;
+            touch(found->second);
+        } else {
+            missCount++;
+            Program program = optimizeProgram(calc.compileTokens(tokens));
+            
+            if (entries.size() == capacity) evictLast();
+            entries.push_front({key, move(program), false, 0, {}});
+            found = byKey.emplace(key, entries.begin()).first;
+        }
+        
+        // Написаний одной записи может быть сколько угодно - запоминаются только первые
+        // MAX_ALIASES, остальные находятся через ключ; вместе с записью вытесняются и они
+        if (found->second->aliases.size() < MAX_ALIASES) {
+            found->second->aliases.push_back(text);
+            byText[text] = found->second;
+        }
+        return found->second;
+    }
+    
+public:
+    ExpressionCache(RPNCalculator& calculator, size_t maxEntries = 256)
+        : calc(calculator), capacity(max<size_t>(1, maxEntries)) {}
+    
+    ExpressionCache(const ExpressionCache&) = delete;
+    ExpressionCache& operator=(const ExpressionCache&) = delete;
+    
+    // Ссылка действительна до следующего обращения к кэшу
+    const Program& compile(const string& expression) {
+        return lookup(expression)->program;
+    }
+    
+    double evaluate(const string& expression) {
+        Entry& entry = *lookup(expression);
+        if (!entry.hasValue) {
+            if (!entry.program.variables.empty()) {
+                throw runtime_error("Invalid token: " + entry.program.variables[0]);
+            }
+            entry.value = calc.execute(entry.program, nullptr);
+            entry.hasValue = true;
+        }
+        return entry.value;
+    }
+    
+    double evaluate(const string& expression, const vector<double>& values) {
+        return calc.execute(compile(expression), values);
+    }
+    
+    long long hits() const {
+        return hitCount;
+    }
+    
+    long long misses() const {
+        return missCount;
+    }
+    
+    size_t size() const {
+        return entries.size();
+    }
+    
+    void clear() {
+        entries.clear();
+        byKey.clear();
+        byText.clear();
+        hitCount = missCount = 0;
+    }
+};
+
+template <typename Func>
+double measureMs(Func action) {
+    auto start = chrono::steady_clock::now();
+    action();
+    auto finish = chrono::steady_clock::now();
+    return chrono::duration<double, milli>(finish - start).count();
+}
+
+void runBytecodeBenchmark(RPNCalculator& calc) {
+    cout << "\n╔════════════════════════════════════════╗" << endl;
+    cout << "║   БЕНЧМАРК: БАЙТКОД                   ║" << endl;
+    cout << "╚════════════════════════════════════════╝" << endl;
+    
+    const string formula = "(x + 2) * (y - 3) / (x * y + 1) ^ 2 + x / 7";
+    cout << "Формула: " << formula << endl;
+    
+    const int textRows = 100000;
+    const int compiledRows = 10000000;
+    double checksum = 0;
+    
+    // Прежний путь: значения подставляются в текст и выражение разбирается заново для каждой строки
+    double textMs = measureMs([&] {
+        for (int row = 0; row < textRows; row++) {
+            ostringstream text;
+            text << "(" << row % 100 << " + 2) * (" << row % 37 << " - 3) / ("
+                 << row % 100 << " * " << row % 37 << " + 1) ^ 2 + " << row % 100 << " / 7";
+            checksum += calc.evaluateInfix(text.str());
+        }
+    });
+    
+    Program program;
+    double compileMs = measureMs([&] { program = calc.compile(formula); });
+    
+    double compiledMs = measureMs([&] {
+        double values[2];
+        for (int row = 0; row < compiledRows; row++) {
+            values[0] = row % 100;
+            values[1] = row % 37;
+            checksum += calc.execute(program, values);
+        }
+    });
+    
+    cout << "Команд: " << program.code.size() << ", констант: " << program.constants.size()
+         << ", переменных: " << program.variables.size() << endl;
+    cout << fixed << setprecision(0);
+    cout << "evaluateInfix с подстановкой: " << textRows / (textMs / 1000) << " вычислений/с" << endl;
+    cout << "Компиляция:                   " << setprecision(3) << compileMs << " мс" << endl;
+    cout << "Байткод:                      " << setprecision(0) << compiledRows / (compiledMs / 1000)
+         << " вычислений/с" << endl;
+    cout << "Контрольная сумма: " << scientific << setprecision(6) << checksum << defaultfloat << endl;
+}
+
+template <template <typename> class StackType>
+double measureStackNsPerOp(int operations) {
+    long long checksum = 0;
+    double ms = measureMs([&] {
+        StackType<int> stack;
+        for (int i = 0; i < operations; i++) {
+            stack.push(i);
+            stack.push(i + 1);
+            checksum += stack.pop();
+            if (i % 4 == 3) {
+                while (!stack.isEmpty()) checksum += stack.pop();
+            }
+        }
+    });
+    if (checksum == 42) cout << "";
+    return ms * 1e6 / operations;
+}
+
+void runStackBenchmark(RPNCalculator& calc) {
+    cout << "\n╔════════════════════════════════════════╗" << endl;
+    cout << "║   БЕНЧМАРК: СТЕК НА МАССИВЕ И СПИСКЕ  ║" << endl;
+    cout << "╚════════════════════════════════════════╝" << endl;
+    
+    const int operations = 10000000;
+    cout << fixed << setprecision(2);
+    cout << "push/push/pop, нс на итерацию:" << endl;
+    cout << "  LinkedStack: " << measureStackNsPerOp<LinkedStack>(operations) << endl;
+    cout << "  Stack:       " << measureStackNsPerOp<DefaultStack>(operations) << endl;
+    
+    const string rpn = "15 7 1 1 + - / 3 * 2 1 1 + + -";
+    const string infix = "(2 + 3) * (4 - 1) / 5 + 2 ^ 3";
+    const int repeats = 200000;
+    double checksum = 0;
+    
+    double linkedRpn = measureMs([&] {
+        for (int i = 0; i < repeats; i++) checksum += calc.evaluateRPN<LinkedStack>(rpn);
+    });
+    double arrayRpn = measureMs([&] {
+        for (int i = 0; i < repeats; i++) checksum += calc.evaluateRPN<DefaultStack>(rpn);
+    });
+    double linkedInfix = measureMs([&] {
+        for (int i = 0; i < repeats; i++) checksum += calc.evaluateInfix<LinkedStack>(infix);
+    });
+    double arrayInfix = measureMs([&] {
+        for (int i = 0; i < repeats; i++) checksum += calc.evaluateInfix<DefaultStack>(infix);
+    });
+    
+    cout << "\nevaluateRPN(\"" << rpn << "\"), нс на вызов:" << endl;
+    cout << "  LinkedStack: " << linkedRpn * 1e6 / repeats << endl;
+    cout << "  Stack:       " << arrayRpn * 1e6 / repeats << endl;
+    cout << "evaluateInfix(\"" << infix << "\"), нс на вызов:" << endl;
+    cout << "  LinkedStack: " << linkedInfix * 1e6 / repeats << endl;
+    cout << "  Stack:       " << arrayInfix * 1e6 / repeats << endl;
+    cout << "Контрольная сумма: " << scientific << setprecision(6) << checksum << defaultfloat << endl;
+}
+
+// Чтение числовых столбцов CSV по именам заголовков; нечисловые и пустые значения становятся NaN
+vector<vector<double>> loadCsvColumns(const string& filename, const vector<string>& names) {
+    ifstream file(filename);
+    if (!file) {
+        throw runtime_error("Cannot open file: " + filename);
+    }
+    
+    auto splitLine = [](const string& line) {
+        vector<string> fields;
+        string field;
+        bool quoted = false;
+        
+        for (char c : line) {
+            if (c == '"') {
+                quoted = !quoted;
+            } else if (c == ',' && !quoted) {
+                fields.push_back(field);
+                field.clear();
+            } else if (c != '\r') {
+                field += c;
+            }
+        }
+        fields.push_back(field);
+        return fields;
+    };
+    
+    string line;
+    getline(file, line);
+    vector<string> header = splitLine(line);
+    vector<int> indices;
+    
+    for (const string& name : names) {
+        auto it = find(header.begin(), header.end(), name);
+        if (it == header.end()) {
+            throw runtime_error("Column not found: " + name);
+        }
+        indices.push_back(it - header.begin());
+    }
+    
+    vector<vector<double>> columns(names.size());
+    while (getline(file, line)) {
+        if (line.empty()) continue;
+        vector<string> fields = splitLine(line);
+        
+        for (size_t i = 0; i < indices.size(); i++) {
+            double value = numeric_limits<double>::quiet_NaN();
+            if (indices[i] < (int)fields.size() && !fields[indices[i]].empty()) {
+                char* end;
+                double parsed = strtod(fields[indices[i]].c_str(), &end);
+                if (*end == '\0') value = parsed;
+            }
+            columns[i].push_back(value);
+        }
+    }
+    
+    return columns;
+}
+
+void runColumnBenchmark(RPNCalculator& calc) {
+    cout << "\n╔════════════════════════════════════════╗" << endl;
+    cout << "║   БЕНЧМАРК: СТОЛБЦОВЫЙ РЕЖИМ          ║" << endl;
+    cout << "╚════════════════════════════════════════╝" << endl;
+    
+    const string formula = "(fare * 1.2 + age / 3) * (fare - age) / (age + 1) ^ 2";
+    const size_t rows = 10000000;
+    Program program = calc.compile(formula);
+    
+    vector<vector<double>> columns(program.variables.size(), vector<double>(rows));
+    for (size_t i = 0; i < rows; i++) {
+        columns[0][i] = 5 + i % 500 * 0.1;
+        columns[1][i] = 1 + i % 80;
+    }
+    
+    double checksum = 0;
+    double rowMs = measureMs([&] {
+        double values[2];
+        for (size_t i = 0; i < rows; i++) {
+            values[0] = columns[0][i];
+            values[1] = columns[1][i];
+            checksum += calc.execute(program, values);
+        }
+    });
+    
+    vector<double> results;
+    double singleMs = measureMs([&] { results = calc.executeColumns(program, columns, 1); });
+    checksum += results[rows / 2];
+    double parallelMs = measureMs([&] { results = calc.executeColumns(program, columns); });
+    checksum += results[rows / 3];
+    
+    cout << "Формула: " << formula << endl;
+    cout << "Строк: " << rows << ", потоков: " << max(1u, thread::hardware_concurrency()) << endl;
+    cout << fixed << setprecision(1);
+    cout << "По строкам (execute):        " << rows / (rowMs / 1000) / 1e6 << " млн строк/с" << endl;
+    cout << "Столбцы, 1 поток:            " << rows / (singleMs / 1000) / 1e6 << " млн строк/с" << endl;
+    cout << "Столбцы, все потоки:         " << rows / (parallelMs / 1000) / 1e6 << " млн строк/с" << endl;
+    cout << "Контрольная сумма: " << scientific << setprecision(6) << checksum << defaultfloat << endl;
+}
+
+void runSpecializationBenchmark(RPNCalculator& calc) {
+    cout << "\n╔════════════════════════════════════════╗" << endl;
+    cout << "║   БЕНЧМАРК: СПЕЦИАЛИЗАЦИЯ ВЫРАЖЕНИЙ   ║" << endl;
+    cout << "╚════════════════════════════════════════╝" << endl;
+    
+    const string formula = "(x * 2 + 3 * 4) ^ 2 + (y - 1) ^ 3 / (2 + 3) + x * y - (x + 0.5) ^ 4";
+    const int rows = 10000000;
+    
+    Program program = calc.compile(formula);
+    SpecializedExpression specialized(program);
+    
+    double interpreted = 0, closures = 0;
+    double interpreterMs = measureMs([&] {
+        double values[2];
+        for (int row = 0; row < rows; row++) {
+            values[0] = row % 100 * 0.25;
+            values[1] = row % 37;
+            interpreted += calc.execute(program, values);
+        }
+    });
+    double specializedMs = measureMs([&] {
+        double values[2];
+        for (int row = 0; row < rows; row++) {
+            values[0] = row % 100 * 0.25;
+            values[1] = row % 37;
+            closures += specialized(values);
+        }
+    });
+    
+    cout << "Формула: " << formula << endl;
+    cout << "Команд байткода: " << program.code.size() << ", замыканий: " << specialized.size() << endl;
+    cout << fixed << setprecision(1);
+    cout << "Интерпретатор:    " << rows / (interpreterMs / 1000) / 1e6 << " млн вычислений/с" << endl;
+    cout << "Специализация:    " << rows / (specializedMs / 1000) / 1e6 << " млн вычислений/с" << endl;
+    cout << "Расхождение сумм: " << scientific << setprecision(2)
+         << abs(interpreted - closures) / abs(interpreted) << defaultfloat << endl;
+}
+
+void runOptimizerBenchmark(RPNCalculator& calc) {
+    cout << "\n╔════════════════════════════════════════╗" << endl;
+    cout << "║   БЕНЧМАРК: ОПТИМИЗАЦИЯ ВЫРАЖЕНИЙ     ║" << endl;
+    cout << "╚════════════════════════════════════════╝" << endl;
+    
+    // Формула с повторяющимися подвыражениями и константными частями
+    const string term = "sqrt(x * x + y * y)";
+    string formula = "max(" + term + ", 1)";
+    for (int i = 1; i <= 8; i++) {
+        formula += " + exp(" + to_string(i) + " - " + term + ") * log(" + term + " + 2 * 3)";
+        formula += " + min(x * y, y * x) * (" + to_string(i) + " * 0.5 + 1)";
+    }
+    const int rows = 2000000;
+    
+    Program plain = calc.compile(formula, false);
+    Program optimized = calc.compile(formula);
+    
+    double plainSum = 0, optimizedSum = 0;
+    double plainMs = measureMs([&] {
+        double values[2];
+        for (int row = 0; row < rows; row++) {
+            values[0] = row % 100 * 0.25;
+            values[1] = row % 37;
+            plainSum += calc.execute(plain, values);
+        }
+    });
+    double optimizedMs = measureMs([&] {
+        double values[2];
+        for (int row = 0; row < rows; row++) {
+            values[0] = row % 100 * 0.25;
+            values[1] = row % 37;
+            optimizedSum += calc.execute(optimized, values);
+        }
+    });
+    
+    cout << "Формула: " << formula.size() << " символов, " << optimized.variables.size() << " переменные" << endl;
+    cout << "Команд без оптимизации: " << plain.code.size() << ", констант: " << plain.constants.size() << endl;
+    cout << "Команд с оптимизацией:  " << optimized.code.size() << ", констант: " << optimized.constants.size()
+         << ", временных ячеек: " << optimized.tempCount << endl;
+    cout << fixed << setprecision(2);
+    cout << "Без оптимизации:  " << rows / (plainMs / 1000) / 1e6 << " млн вычислений/с" << endl;
+    cout << "С оптимизацией:   " << rows / (optimizedMs / 1000) / 1e6 << " млн вычислений/с" << endl;
+    cout << "Расхождение сумм: " << scientific << setprecision(2)
+         << abs(plainSum - optimizedSum) / abs(plainSum) << defaultfloat << endl;
+}
+
+void runCacheBenchmark(RPNCalculator& calc, ExpressionCache& cache) {
+    cout << "\n╔════════════════════════════════════════╗" << endl;
+    cout << "║   БЕНЧМАРК: КЭШ ВЫРАЖЕНИЙ             ║" << endl;
+    cout << "╚════════════════════════════════════════╝" << endl;
+    
+    // Одни и те же формулы в разной записи: пробелы и порядок аргументов
+    const vector<string> formulas = {
+        "(15 + 7) * 3 / (2 ^ 4 - 1)",
+        "3*(7+15)/(2^4-1)",
+        "sqrt(2) * max(3, 4) + 1.50",
+        "max(4,3)*sqrt(2.0)+1.5",
+        "  (1 + 2 + 3) * (4 + 5) - exp(1) ",
+        "(9) * (1+2+3) - exp(1)",
+        "100 / (3 + 4) / (5 - 2)",
+        "log(10) * log(10) + 2 ^ 10"
+    };
+    const int requests = 1000000;
+    
+    double direct = 0, cached = 0;
+    double directMs = measureMs([&] {
+        for (int i = 0; i < requests; i++) {
+            direct += calc.evaluateInfix(formulas[i % formulas.size()]);
+        }
+    });
+    
+    cache.clear();
+    double cachedMs = measureMs([&] {
+        for (int i = 0; i < requests; i++) {
+            cached += cache.evaluate(formulas[i % formulas.size()]);
+        }
+    });
+    
+    cout << "Запросов: " << requests << ", различных строк: " << formulas.size() << endl;
+    cout << "Попаданий: " << cache.hits() << ", промахов: " << cache.misses()
+         << ", записей в кэше: " << cache.size() << endl;
+    cout << fixed << setprecision(3);
+    cout << "evaluateInfix:  " << requests / (directMs / 1000) / 1e6 << " млн запросов/с" << endl;
+    cout << "С кэшем:        " << requests / (cachedMs / 1000) / 1e6 << " млн запросов/с" << endl;
+    cout << "Расхождение сумм: " << scientific << setprecision(2)
+         << abs(direct - cached) / abs(direct) << defaultfloat << endl;
+}
+
+void runParseBenchmark(RPNCalculator& calc) {
+    cout << "\n╔════════════════════════════════════════╗" << endl;
+    cout << "║   БЕНЧМАРК: РАЗБОР ВЫРАЖЕНИЙ          ║" << endl;
+    cout << "╚════════════════════════════════════════╝" << endl;
+    
+    const vector<string> infix = {
+        "(2 + 3) * (4 - 1) / 5 + 2 ^ 3",
+        "sqrt(16.25) * max(3.5, 4) + 1.5 / (7 - 2.25)",
+        "((1.125 + 2) * (3 - 4.5) + (5.75 * 6) / (7 + 8)) ^ 2 - min(9, 10.5) * 11"
+    };
+    vector<string> rpn;
+    for (const string& expression : infix) rpn.push_back(calc.infixToRPN(expression));
+    const int repeats = 200000;
+    
+    double checksum = 0;
+    size_t characters = 0;
+    vector<Token> tokens;
+    
+    cout << "Выражений: " << infix.size() << ", повторов: " << repeats << endl;
+    cout << "\nнс на выражение       stringstream   string_view" << endl;
+    
+    auto report = [&](const string& label, double streamMs, double viewMs) {
+        double calls = (double)repeats * infix.size();
+        cout << label << fixed << setprecision(1) << setw(12) << streamMs * 1e6 / calls
+             << setw(14) << viewMs * 1e6 / calls << "   (x" << setprecision(2) << streamMs / viewMs << ")" << endl;
+    };
+    
+    double streamMs = measureMs([&] {
+        for (int i = 0; i < repeats; i++)
+            for (const string& expression : infix) characters += calc.infixToRPNStream(expression).size();
+    });
+    double viewMs = measureMs([&] {
+        for (int i = 0; i < repeats; i++)
+            for (const string& expression : infix) {
+                calc.infixToTokens(expression, tokens);
+                characters += tokens.size();
+            }
+    });
+    report("Инфикс → постфикс:  ", streamMs, viewMs);
+    
+    streamMs = measureMs([&] {
+        for (int i = 0; i < repeats; i++)
+            for (const string& expression : rpn) checksum += calc.evaluateRPNStream(expression);
+    });
+    viewMs = measureMs([&] {
+        for (int i = 0; i < repeats; i++)
+            for (const string& expression : rpn) checksum += calc.evaluateRPN(expression);
+    });
+    report("evaluateRPN:        ", streamMs, viewMs);
+    
+    streamMs = measureMs([&] {
+        for (int i = 0; i < repeats; i++)
+            for (const string& expression : infix) checksum += calc.evaluateInfixStream(expression);
+    });
+    viewMs = measureMs([&] {
+        for (int i = 0; i < repeats; i++)
+            for (const string& expression : infix) checksum += calc.evaluateInfix(expression);
+    });
+    report("evaluateInfix:      ", streamMs, viewMs);
+    
+    cout << "Контрольная сумма: " << scientific << setprecision(6) << checksum + characters << defaultfloat << endl;
+}
+
+void runExactEvaluation(RPNCalculator& calc) {
+    string expr;
+    cout << "\nВведите инфиксное выражение: ";
+    getline(cin, expr);
+    
+    Program program = calc.compile(expr, false);
+    NumericProgram<double> doubles(program);
+    NumericProgram<Rational> rationals(program);
+    NumericProgram<Decimal> decimals(program);
+    
+    vector<double> doubleValues;
+    vector<Rational> rationalValues;
+    vector<Decimal> decimalValues;
+    for (const string& name : program.variables) {
+        string text;
+        cout << name << " = ";
+        cin >> text;
+        doubleValues.push_back(NumericPolicy<double>::parse(text));
+        rationalValues.push_back(Rational::parse(text));
+        decimalValues.push_back(Decimal::parse(text));
+    }
+    if (!program.variables.empty()) cin.ignore();
+    
+    cout << "\n╔════════════════════════════════════════╗" << endl;
+    cout << "║           РЕЗУЛЬТАТ                   ║" << endl;
+    cout << "╚════════════════════════════════════════╝" << endl;
+    cout << "Выражение:     " << expr << endl;
+    cout << "double:        " << setprecision(17) << doubles.evaluate(doubleValues.data()) << setprecision(6) << endl;
+    cout << "Рациональное:  " << rationals.evaluate(rationalValues.data()).toString() << endl;
+    cout << "Десятичное:    " << decimals.evaluate(decimalValues.data()).toString() << endl;
+}
+
+void runExactBenchmark(RPNCalculator& calc) {
+    cout << "\n╔════════════════════════════════════════╗" << endl;
+    cout << "║   БЕНЧМАРК: ТОЧНАЯ АРИФМЕТИКА         ║" << endl;
+    cout << "╚════════════════════════════════════════╝" << endl;
+    
+    cout << "\n--- Умножение больших целых, мкс ---" << endl;
+    cout << "Разрядов 2^32    столбиком    Карацуба" << endl;
+    mt19937_64 rng(42);
+    for (int limbs : {16, 64, 256, 1024, 4096}) {
+        string text = "1";
+        for (int i = 0; i < limbs * 96 / 10; i++) text += char('0' + rng() % 10);
+        BigInteger a = BigInteger::parse(text);
+        BigInteger b = a + BigInteger(12345);
+        
+        int repeats = max(3, 2000000 / (limbs * limbs));
+        BigInteger basic, fast;
+        double basicMs = measureMs([&] {
+            for (int i = 0; i < repeats; i++) basic = BigInteger::multiplySchoolbook(a, b);
+        });
+        double fastMs = measureMs([&] {
+            for (int i = 0; i < repeats; i++) fast = a * b;
+        });
+        
+        cout << setw(12) << a.limbs() << fixed << setprecision(1)
+             << setw(14) << basicMs * 1000 / repeats << setw(12) << fastMs * 1000 / repeats
+             << (basic == fast ? "" : "   РАСХОЖДЕНИЕ") << endl;
+    }
+    
+    const string formula = "principal * (1 + rate / 12) ^ 12 - fee * 12 + min(principal, 1000.5) / 3";
+    Program program = calc.compile(formula, false);
+    cout << "\n--- Вычисление формулы ---" << endl;
+    cout << "Формула: " << formula << endl;
+    cout << "Переменные: ";
+    for (const string& name : program.variables) cout << name << " ";
+    cout << endl;
+    
+    const int rows = 1000;
+    vector<string> inputs;
+    for (int row = 0; row < rows; row++) {
+        inputs.push_back(to_string(1000 + row) + "." + to_string(row % 100));
+        inputs.push_back("0.0" + to_string(1 + row % 9) + "5");
+        inputs.push_back(to_string(row % 7) + ".99");
     }
     
-    int getSize() const {
-        return size;
+    auto measure = [&](auto zero, const string& label, int repeats) {
+        typedef decltype(zero) Number;
+        NumericProgram<Number> compiled(program);
+        vector<Number> values;
+        for (const string& text : inputs) values.push_back(NumericPolicy<Number>::parse(text));
+        
+        Number last = zero;
+        double ms = measureMs([&] {
+            for (int r = 0; r < repeats; r++)
+                for (int row = 0; row < rows; row++) last = compiled.evaluate(&values[row * 3]);
+        });
+        cout << label << fixed << setprecision(3) << setw(10) << rows * repeats / (ms / 1000) / 1e6
+             << " млн вычислений/с" << endl;
+        return last;
+    };
+    
+    double lastDouble = measure(0.0, "double:        ", 1000);
+    Rational lastRational = measure(Rational(0), "Рациональное:  ", 5);
+    Decimal lastDecimal = measure(Decimal(0), "Десятичное:    ", 20);
+    
+    cout << "\nПоследняя строка:" << endl;
+    cout << "  double:       " << setprecision(17) << defaultfloat << lastDouble << setprecision(6) << endl;
+    cout << "  десятичное:   " << lastDecimal.toString() << endl;
+    string fraction = lastRational.toString();
+    cout << "  рациональное: " << (fraction.size() > 70 ? fraction.substr(0, 70) + "..." : fraction)
+         << " (" << fraction.size() << " символов)" << endl;
+}
+
+// Прямой режим: по одному проходу с дуальными числами на каждую переменную
+vector<double> forwardGradient(NumericProgram<Dual>& program, const vector<double>& values) {
+    vector<Dual> duals(values.begin(), values.end());
+    vector<double> gradient(values.size());
+    
+    for (size_t i = 0; i < values.size(); i++) {
+        duals[i].derivative = 1;
+        gradient[i] = program.evaluate(duals.data()).derivative;
+        duals[i].derivative = 0;
     }
+    return gradient;
+}
+
+// Центральные разности: 2N дополнительных вычислений
+vector<double> finiteDifferenceGradient(RPNCalculator& calc, const Program& program, vector<double> values) {
+    vector<double> gradient(values.size());
     
-    void clear() {
-        while (!isEmpty()) {
-            pop();
-        }
+    for (size_t i = 0; i < values.size(); i++) {
+        double x = values[i];
+        double h = 1e-6 * max(1.0, abs(x));
+        values[i] = x + h;
+        double up = calc.execute(program, values);
+        values[i] = x - h;
+        double down = calc.execute(program, values);
+        values[i] = x;
+        gradient[i] = (up - down) / (2 * h);
     }
-};
+    return gradient;
+}
 
-class RPNCalculator {
-private:
+void runGradientEvaluation(RPNCalculator& calc) {
+    string expr;
+    cout << "\nВведите инфиксное выражение с переменными: ";
+    getline(cin, expr);
     
-    bool isOperator(char c) {
-        return c == '+' || c == '-' || c == '*' || c == '/' || c == '^';
+    Program program = calc.compile(expr);
+    vector<double> values(program.variables.size());
+    for (size_t i = 0; i < values.size(); i++) {
+        cout << program.variables[i] << " = ";
+        cin >> values[i];
     }
+    if (!values.empty()) cin.ignore();
     
-    int getPrecedence(char op) {
-        if (op == '+' || op == '-') return 1;
-        if (op == '*' || op == '/') return 2;
-        if (op == '^') return 3;
-        return 0;
+    GradientProgram reverse(program);
+    NumericProgram<Dual> forward(program);
+    vector<double> gradient(values.size());
+    double value = reverse.evaluate(values.data(), gradient.data());
+    vector<double> tangents = forwardGradient(forward, values);
+    vector<double> differences = finiteDifferenceGradient(calc, program, values);
+    
+    cout << "\n╔════════════════════════════════════════╗" << endl;
+    cout << "║           ГРАДИЕНТ                    ║" << endl;
+    cout << "╚════════════════════════════════════════╝" << endl;
+    cout << "Выражение: " << expr << endl;
+    cout << "Значение:  " << setprecision(12) << value << endl;
+    for (size_t i = 0; i < values.size(); i++) {
+        cout << "d/d" << program.variables[i] << ": обратный " << gradient[i] << ", прямой " << tangents[i]
+             << ", разности " << differences[i] << endl;
     }
+    cout << setprecision(6);
+}
+
+void runGradientBenchmark(RPNCalculator& calc) {
+    cout << "\n╔════════════════════════════════════════╗" << endl;
+    cout << "║   БЕНЧМАРК: АВТОМАТИЧЕСКАЯ ПРОИЗВОДНАЯ║" << endl;
+    cout << "╚════════════════════════════════════════╝" << endl;
     
-    bool isRightAssociative(char op) {
-        return op == '^';
+    const int variableCount = 8;
+    string formula;
+    for (int i = 0; i < variableCount; i++) {
+        string x = "p" + to_string(i), y = "p" + to_string((i + 1) % variableCount);
+        if (i > 0) formula += " + ";
+        formula += "exp(0 - " + x + " * " + x + ") * " + y + " + sqrt(" + x + " * " + x + " + 1) / (" + y + " + 3)";
     }
     
-    double applyOperator(double a, double b, char op) {
-        switch (op) {
-            case '+': return a + b;
-            case '-': return a - b;
-            case '*': return a * b;
-            case '/':
-                if (b == 0) throw runtime_error("Division by zero");
-                return a / b;
-            case '^': return pow(a, b);
-            default: throw runtime_error("Unknown operator");
-        }
+    Program program = calc.compile(formula);
+    GradientProgram reverse(program);
+    NumericProgram<Dual> forward(program);
+    const int rows = 200000;
+    
+    vector<vector<double>> columns(program.variables.size(), vector<double>(rows));
+    for (size_t v = 0; v < columns.size(); v++) {
+        for (int row = 0; row < rows; row++) columns[v][row] = 0.1 + (row * (v + 3) % 97) * 0.02;
     }
     
-public:
+    vector<double> values(program.variables.size()), gradient(program.variables.size());
+    auto loadRow = [&](int row) {
+        for (size_t v = 0; v < values.size(); v++) values[v] = columns[v][row];
+    };
     
-    double evaluateRPN(const string& expression) {
-        Stack<double> stack;
-        stringstream ss(expression);
-        string token;
-        
-        while (ss >> token) {
-            if (isdigit(token[0]) || (token.length() > 1 && token[0] == '-')) {
-                stack.push(stod(token));
-            }
-            else if (token.length() == 1 && isOperator(token[0])) {
-                if (stack.getSize() < 2) {
-                    throw runtime_error("Invalid expression: not enough operands");
-                }
-                
-                double b = stack.pop();
-                double a = stack.pop();
-                double result = applyOperator(a, b, token[0]);
-                stack.push(result);
-            }
-            else {
-                throw runtime_error("Invalid token: " + token);
-            }
+    double checksum = 0, maxError = 0;
+    double plainMs = measureMs([&] {
+        for (int row = 0; row < rows; row++) {
+            loadRow(row);
+            checksum += calc.execute(program, values);
         }
-        
-        if (stack.getSize() != 1) {
-            throw runtime_error("Invalid expression: too many operands");
+    });
+    double differenceMs = measureMs([&] {
+        for (int row = 0; row < rows; row++) {
+            loadRow(row);
+            checksum += finiteDifferenceGradient(calc, program, values)[0];
         }
-        
-        return stack.pop();
-    }
-    
-    string infixToRPN(const string& expression) {
-        Stack<char> operators;
-        stringstream output;
-        
-        for (size_t i = 0; i < expression.length(); i++) {
-            char c = expression[i];
-            
-            if (isspace(c)) continue;
-            
-            if (isdigit(c) || c == '.') {
-                output << c;
-                
-                while (i + 1 < expression.length() && 
-                       (isdigit(expression[i + 1]) || expression[i + 1] == '.')) {
-                    output << expression[++i];
-                }
-                output << ' ';
-            }
-            else if (c == '(') {
-                operators.push(c);
-            }
-            else if (c == ')') {
-                while (!operators.isEmpty() && operators.peek() != '(') {
-                    output << operators.pop() << ' ';
-                }
-                
-                if (operators.isEmpty()) {
-                    throw runtime_error("Mismatched parentheses");
-                }
-                
-                operators.pop();
-            }
-            else if (isOperator(c)) {
-                while (!operators.isEmpty() && operators.peek() != '(' &&
-                       (getPrecedence(operators.peek()) > getPrecedence(c) ||
-                        (getPrecedence(operators.peek()) == getPrecedence(c) && 
-                         !isRightAssociative(c)))) {
-                    output << operators.pop() << ' ';
-                }
-                operators.push(c);
-            }
-            else {
-                throw runtime_error(string("Invalid character: ") + c);
-            }
+    });
+    double forwardMs = measureMs([&] {
+        for (int row = 0; row < rows; row++) {
+            loadRow(row);
+            checksum += forwardGradient(forward, values)[0];
         }
-        
-        while (!operators.isEmpty()) {
-            char op = operators.pop();
-            if (op == '(' || op == ')') {
-                throw runtime_error("Mismatched parentheses");
-            }
-            output << op << ' ';
+    });
+    double reverseMs = measureMs([&] {
+        for (int row = 0; row < rows; row++) {
+            loadRow(row);
+            checksum += reverse.evaluate(values.data(), gradient.data());
         }
-        
-        return output.str();
-    }
+    });
     
-    double evaluateInfix(const string& expression) {
-        string rpn = infixToRPN(expression);
-        return evaluateRPN(rpn);
+    vector<vector<double>> columnGradient;
+    vector<double> results;
+    double columnsMs = measureMs([&] { results = calc.executeColumns(program, columns); });
+    double columnGradientMs = measureMs([&] { results = calc.executeColumnsGradient(program, columns, columnGradient); });
+    
+    for (int row = 0; row < rows; row += 997) {
+        loadRow(row);
+        vector<double> tangents = forwardGradient(forward, values);
+        reverse.evaluate(values.data(), gradient.data());
+        for (size_t v = 0; v < values.size(); v++) {
+            maxError = max(maxError, abs(tangents[v] - gradient[v]) + abs(columnGradient[v][row] - gradient[v]));
+        }
     }
-};
+    
+    cout << "Переменных: " << program.variables.size() << ", команд: " << program.code.size()
+         << ", строк: " << rows << endl;
+    cout << fixed << setprecision(2);
+    cout << "\nмкс на строку" << endl;
+    cout << "Только значение:          " << plainMs * 1000 / rows << endl;
+    cout << "Разности (2N вычислений): " << differenceMs * 1000 / rows << endl;
+    cout << "Прямой режим (N проходов):" << forwardMs * 1000 / rows << endl;
+    cout << "Обратный режим (1 проход):" << reverseMs * 1000 / rows
+         << "  (x" << reverseMs / plainMs << " к значению)" << endl;
+    cout << "Столбцы, значение:        " << columnsMs * 1000 / rows << endl;
+    cout << "Столбцы, с градиентом:    " << columnGradientMs * 1000 / rows
+         << "  (x" << columnGradientMs / columnsMs << " к значению)" << endl;
+    cout << "Расхождение режимов: " << scientific << setprecision(2) << maxError
+         << ", контрольная сумма: " << checksum << defaultfloat << setprecision(6) << endl;
+}
 
 void displayMenu() {
     cout << "\n╔════════════════════════════════════════╗" << endl;
@@ -204,6 +3264,19 @@ void displayMenu() {
     cout << "2. Вычислить инфиксное выражение" << endl;
     cout << "3. Конвертировать инфикс → постфикс" << endl;
     cout << "4. Примеры использования" << endl;
+    cout << "5. Вычислить выражение с переменными" << endl;
+    cout << "6. Бенчмарк байткода" << endl;
+    cout << "7. Бенчмарк стеков" << endl;
+    cout << "8. Вычислить выражение по столбцам CSV" << endl;
+    cout << "9. Бенчмарк столбцового режима" << endl;
+    cout << "10. Бенчмарк специализации выражений" << endl;
+    cout << "11. Бенчмарк оптимизации выражений" << endl;
+    cout << "12. Бенчмарк кэша выражений" << endl;
+    cout << "13. Бенчмарк разбора выражений" << endl;
+    cout << "14. Точное вычисление (рациональные и десятичные числа)" << endl;
+    cout << "15. Бенчмарк точной арифметики" << endl;
+    cout << "16. Градиент выражения" << endl;
+    cout << "17. Бенчмарк автоматического дифференцирования" << endl;
     cout << "0. Выход" << endl;
     cout << "───────────────────────────────────────" << endl;
     cout << "Выберите действие: ";
@@ -232,14 +3305,279 @@ void showExamples() {
     cout << "  2 ^ 3          →  8" << endl;
     cout << "  (2 + 3) * (4 - 1)  →  15" << endl;
     
+    cout << "\n--- ПЕРЕМЕННЫЕ (пункт 5) ---" << endl;
+    cout << "  (x + 1) * y    при x = 2, y = 3  →  9" << endl;
+    
+    cout << "\n--- ФУНКЦИИ ---" << endl;
+    cout << "  sqrt(16) + log(1)   →  4" << endl;
+    cout << "  max(2, exp(1))      →  2.71828" << endl;
+    cout << "  min(x, y) * 2       при x = 2, y = 3  →  4" << endl;
+    
     cout << "\nПоддерживаемые операторы: + - * / ^" << endl;
+    cout << "Функции: sqrt log exp min max" << endl;
     cout << "Можно использовать скобки и дробные числа" << endl;
 }
 
-int main() {
+// Потоковый пакетный режим: по одному выражению в строке, ответы выводятся в том же порядке.
+// Вход читается большими блоками; блок режется на куски, которые постоянные рабочие потоки
+// забирают из очереди, а тем временем читается следующий блок. Каждая строка вычисляется
+// через кэш скомпилированных выражений: ключ точен до дерева выражения, поэтому ответ не
+// зависит от того, какие строки встречались раньше и как блок поделен между потоками
+class BatchEvaluator {
+private:
+    static const size_t READ_CHUNK = 1 << 20;
+    static const int JOBS_PER_THREAD = 4;
+    
+    struct Worker {
+        RPNCalculator calc;
+        ExpressionCache cache;
+        
+        Worker() : cache(calc, 1024) {}
+    };
+    
+    struct Line {
+        size_t offset;
+        size_t length;
+    };
+    
+    struct Job {
+        size_t first;
+        size_t last;
+        string output;
+        long long errors = 0;
+    };
+    
+    FILE* input;
+    int threadCount;
+    string carry;
+    vector<unique_ptr<Worker>> workers;
+    vector<thread> threads;
+    
+    mutex lock;
+    condition_variable jobReady;
+    condition_variable jobDone;
+    const string* batch = nullptr;
+    const vector<Line>* lines = nullptr;
+    long long lineBase = 0;
+    vector<Job> jobs;
+    size_t nextJob = 0;
+    size_t pendingJobs = 0;
+    bool stopping = false;
+    
+    // Дочитывает вход до конца последней полной строки; хвост остается в carry
+    bool readBatch(string& batch) {
+        batch.swap(carry);
+        carry.clear();
+        
+        while (true) {
+            size_t old = batch.size();
+            batch.resize(old + READ_CHUNK);
+            size_t got = fread(&batch[old], 1, READ_CHUNK, input);
+            batch.resize(old + got);
+            
+            if (got == 0) {
+                if (ferror(input)) throw runtime_error("Read error");
+                if (!batch.empty() && batch.back() != '\n') batch += '\n';
+                return !batch.empty();
+            }
+            
+            size_t last = batch.rfind('\n');
+            if (last != string::npos) {
+                carry.assign(batch, last + 1, string::npos);
+                batch.resize(last + 1);
+                return true;
+            }
+        }
+    }
+    
+    static void splitLines(const string& batch, vector<Line>& lines) {
+        lines.clear();
+        size_t start = 0;
+        while (start < batch.size()) {
+            size_t end = batch.find('\n', start);
+            size_t length = end - start;
+            if (length > 0 && batch[end - 1] == '\r') length--;
+            lines.push_back({start, length});
+            start = end + 1;
+        }
+    }
+    
+    static void evaluateLines(Worker& worker, const string& batch, const vector<Line>& lines,
+                              Job& job, long long lineBase) {
+        job.output.clear();
+        job.errors = 0;
+        string expression;
+        char number[32];
+        
+        for (size_t i = job.first; i < job.last; i++) {
+            expression.assign(batch, lines[i].offset, lines[i].length);
+            
+            if (expression.find_first_not_of(" \t") == string::npos) {
+                job.output += '\n';
+                continue;
+            }
+            
+            try {
+                double value = worker.cache.evaluate(expression);
+                char* end = to_chars(number, number + sizeof(number), value).ptr;
+                job.output.append(number, end);
+            } catch (const exception& e) {
+                job.errors++;
+                job.output += "error: line " + to_string(lineBase + i + 1) + ": " + e.what();
+            }
+            job.output += '\n';
+        }
+    }
+    
+    void workerLoop(Worker& worker) {
+        unique_lock<mutex> guard(lock);
+        while (true) {
+            jobReady.wait(guard, [&] { return stopping || nextJob < jobs.size(); });
+            if (nextJob >= jobs.size()) return;
+            
+            Job& job = jobs[nextJob++];
+            guard.unlock();
+            evaluateLines(worker, *batch, *lines, job, lineBase);
+            guard.lock();
+            
+            if (--pendingJobs == 0) jobDone.notify_all();
+        }
+    }
+    
+public:
+    BatchEvaluator(FILE* in, int threads) : input(in) {
+        threadCount = threads > 0 ? threads : max(1u, thread::hardware_concurrency());
+        for (int t = 0; t < threadCount; t++) {
+            workers.push_back(make_unique<Worker>());
+        }
+        if (threadCount > 1) {
+            for (int t = 0; t < threadCount; t++) {
+                this->threads.emplace_back(&BatchEvaluator::workerLoop, this, ref(*workers[t]));
+            }
+        }
+    }
+    
+    BatchEvaluator(const BatchEvaluator&) = delete;
+    BatchEvaluator& operator=(const BatchEvaluator&) = delete;
+    
+    ~BatchEvaluator() {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        jobReady.notify_all();
+        for (thread& worker : threads) {
+            worker.join();
+        }
+    }
+    
+    // Возвращает число строк с ошибками
+    long long run(FILE* output, long long& lineCount) {
+        string current, next;
+        vector<Line> currentLines;
+        lineCount = 0;
+        long long errors = 0;
+        bool more = readBatch(current);
+        
+        while (more) {
+            splitLines(current, currentLines);
+            size_t parts = threadCount == 1 ? 1 : (size_t)threadCount * JOBS_PER_THREAD;
+            size_t chunk = (currentLines.size() + parts - 1) / parts;
+            
+            {
+                lock_guard<mutex> guard(lock);
+                batch = &current;
+                lines = &currentLines;
+                lineBase = lineCount;
+                jobs.resize(parts);
+                for (size_t part = 0; part < parts; part++) {
+                    jobs[part].first = min(currentLines.size(), part * chunk);
+                    jobs[part].last = min(currentLines.size(), jobs[part].first + chunk);
+                }
+                nextJob = 0;
+                pendingJobs = parts;
+            }
+            
+            if (threadCount == 1) {
+                evaluateLines(*workers[0], current, currentLines, jobs[0], lineCount);
+                more = readBatch(next);
+            } else {
+                jobReady.notify_all();
+                more = readBatch(next);
+                unique_lock<mutex> guard(lock);
+                jobDone.wait(guard, [&] { return pendingJobs == 0; });
+            }
+            
+            for (const Job& job : jobs) {
+                fwrite(job.output.data(), 1, job.output.size(), output);
+                errors += job.errors;
+            }
+            
+            lineCount += currentLines.size();
+            current.swap(next);
+        }
+        
+        fflush(output);
+        return errors;
+    }
+};
+
+void printBatchUsage() {
+    cerr << "Использование:" << endl;
+    cerr << "  lvl2proj4 batch [-j ПОТОКИ] [ФАЙЛ|-]" << endl;
+    cerr << "Одно инфиксное выражение в строке; без файла или с '-' читается stdin." << endl;
+    cerr << "Результаты выводятся в stdout в порядке строк, ошибки - строкой \"error: ...\"." << endl;
+}
+
+int runBatch(int argc, char* argv[]) {
+    vector<string> args(argv + 1, argv + argc);
+    if (args[0] != "batch") {
+        printBatchUsage();
+        return 2;
+    }
+    
+    int threads = 0;
+    string filename = "-";
+    for (size_t i = 1; i < args.size(); i++) {
+        if (args[i] == "-j" && i + 1 < args.size()) {
+            threads = atoi(args[++i].c_str());
+        } else if (filename == "-") {
+            filename = args[i];
+        } else {
+            printBatchUsage();
+            return 2;
+        }
+    }
+    
+    try {
+        FILE* input = filename == "-" ? stdin : fopen(filename.c_str(), "rb");
+        if (input == nullptr) {
+            throw runtime_error("Cannot open file: " + filename);
+        }
+        
+        BatchEvaluator evaluator(input, threads);
+        long long lines = 0, errors = 0;
+        double ms = measureMs([&] { errors = evaluator.run(stdout, lines); });
+        if (input != stdin) fclose(input);
+        
+        cerr << "Строк: " << lines << ", ошибок: " << errors << ", время: " << fixed << setprecision(1)
+             << ms << " мс (" << lines / (ms / 1000) / 1e6 << " млн строк/с)" << endl;
+        return errors > 0 ? 1 : 0;
+    } catch (const exception& e) {
+        cerr << "✗ ОШИБКА: " << e.what() << endl;
+        return 1;
+    }
+}
+
+int main(int argc, char* argv[]) {
     system("chcp 65001 > nul");
     
+    if (argc > 1) {
+        return runBatch(argc, argv);
+    }
+    
     RPNCalculator calc;
+    ExpressionCache cache(calc);
     int choice;
     
     do {
@@ -269,7 +3607,7 @@ int main() {
                     getline(cin, expr);
                     
                     string rpn = calc.infixToRPN(expr);
-                    double result = calc.evaluateRPN(rpn);
+                    double result = cache.evaluate(expr);
                     
                     cout << "\n╔════════════════════════════════════════╗" << endl;
                     cout << "║           РЕЗУЛЬТАТ                   ║" << endl;
@@ -299,6 +3637,105 @@ int main() {
                     showExamples();
                     break;
                 
+                case 5: {
+                    string expr;
+                    cout << "\nВведите инфиксное выражение с переменными: ";
+                    getline(cin, expr);
+                    
+                    Program program = calc.compile(expr);
+                    vector<double> values(program.variables.size());
+                    
+                    for (size_t i = 0; i < values.size(); i++) {
+                        cout << program.variables[i] << " = ";
+                        cin >> values[i];
+                    }
+                    if (!values.empty()) cin.ignore();
+                    
+                    double result = calc.execute(program, values);
+                    cout << "\n╔════════════════════════════════════════╗" << endl;
+                    cout << "║           РЕЗУЛЬТАТ                   ║" << endl;
+                    cout << "╚════════════════════════════════════════╝" << endl;
+                    cout << "Выражение: " << expr << endl;
+                    cout << "Результат: " << result << endl;
+                    break;
+                }
+                
+                case 6:
+                    runBytecodeBenchmark(calc);
+                    break;
+                
+                case 7:
+                    runStackBenchmark(calc);
+                    break;
+                
+                case 8: {
+                    string filename, expr;
+                    cout << "\nФайл CSV: ";
+                    getline(cin, filename);
+                    cout << "Выражение (переменные - имена столбцов): ";
+                    getline(cin, expr);
+                    
+                    Program program = calc.compile(expr);
+                    vector<vector<double>> columns = loadCsvColumns(filename, program.variables);
+                    vector<double> results = calc.executeColumns(program, columns);
+                    
+                    double sum = 0;
+                    size_t valid = 0;
+                    for (double value : results) {
+                        if (!isnan(value)) {
+                            sum += value;
+                            valid++;
+                        }
+                    }
+                    
+                    cout << "\nСтрок: " << results.size() << ", без пропусков: " << valid << endl;
+                    cout << "Первые значения:";
+                    for (size_t i = 0; i < min<size_t>(10, results.size()); i++) {
+                        cout << " " << results[i];
+                    }
+                    cout << endl;
+                    if (valid > 0) {
+                        cout << "Среднее: " << sum / valid << endl;
+                    }
+                    break;
+                }
+                
+                case 9:
+                    runColumnBenchmark(calc);
+                    break;
+                
+                case 10:
+                    runSpecializationBenchmark(calc);
+                    break;
+                
+                case 11:
+                    runOptimizerBenchmark(calc);
+                    break;
+                
+                case 12:
+                    runCacheBenchmark(calc, cache);
+                    break;
+                
+                case 13:
+                    runParseBenchmark(calc);
+                    break;
+                
+                case 14:
+                    runExactEvaluation(calc);
+                    break;
+                
+                case 15:
+                    runExactBenchmark(calc);
+                    break;
+                
+                case 16:
+                    runGradientEvaluation(calc);
+                    break;
+                
+                case 17:
+                    runGradientBenchmark(calc);
+                    break;
+                
                 case 0:
                     cout << "\nДо свидания!" << endl;
                     break;